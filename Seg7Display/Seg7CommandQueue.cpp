@@ -0,0 +1,223 @@
+/**
+ * @file   Seg7CommandQueue.cpp
+ * @brief  Lock-free command queue for writing to a Seg7Display from several tasks.
+ *
+ * @license
+ * ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include <Seg7Display.h>
+
+#if defined(__AVR__)
+#include <util/atomic.h>
+#endif
+
+static_assert((SEG7_CMD_QUEUE_SIZE & (SEG7_CMD_QUEUE_SIZE-1)) == 0, "SEG7_CMD_QUEUE_SIZE must be a power of two");
+static_assert(SEG7_CMD_QUEUE_SIZE <= 64, "SEG7_CMD_QUEUE_SIZE must be at most 64");
+
+#define QUEUE_MASK	(SEG7_CMD_QUEUE_SIZE-1)
+
+// Signed distance between two queue positions.
+#if defined(__AVR__)
+typedef int16_t queueDiff_t;
+#else
+typedef int32_t queueDiff_t;
+#endif
+
+// Atomic helpers. AVR has no compare-and-swap and no 16 bit load or store instruction, but
+// a single core, so a few cycles with interrupts masked gives the same guarantee against
+// interrupts and against task switches, which are made from interrupts.
+static inline seg7QueuePos_t loadAcquire(volatile seg7QueuePos_t* p)
+{
+#if defined(__AVR__)
+	seg7QueuePos_t v;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		v = *p;
+	}
+	return v;
+#else
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void storeRelease(volatile seg7QueuePos_t* p, seg7QueuePos_t v)
+{
+#if defined(__AVR__)
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		*p = v;
+	}
+#else
+	__atomic_store_n(p, v, __ATOMIC_RELEASE);
+#endif
+}
+
+static inline bool compareSwap(volatile seg7QueuePos_t* p, seg7QueuePos_t& expected, seg7QueuePos_t desired)
+{
+#if defined(__AVR__)
+	bool ok;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		seg7QueuePos_t cur = *p;
+		ok = (cur == expected);
+		if( ok ) {
+			*p = desired;
+		} else {
+			expected = cur;
+		}
+	}
+	return ok;
+#else
+	return __atomic_compare_exchange_n(p, &expected, desired, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline void countDrop(volatile uint16_t* p)
+{
+#if defined(__AVR__)
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		(*p)++;
+	}
+#else
+	__atomic_fetch_add(p, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+// Standard constructor
+Seg7CommandQueue::Seg7CommandQueue()
+{
+	// Cell i is free for the producer that claims position i.
+	for(uint8_t i=0; i<SEG7_CMD_QUEUE_SIZE; i++) {
+		m_cells[i].seq = i;
+	}
+	m_enqueuePos = 0;
+	m_dequeuePos = 0;
+	m_dropped = 0;
+}
+
+// Enqueue one command without blocking.
+uint8_t Seg7CommandQueue::push(const seg7Command_t& cmd)
+{
+	seg7QueuePos_t pos = loadAcquire(&m_enqueuePos);
+	cell_t* cell;
+
+	for(;;) {
+		cell = &m_cells[pos & QUEUE_MASK];
+		queueDiff_t diff = (queueDiff_t)(seg7QueuePos_t)(loadAcquire(&cell->seq) - pos);
+		if( diff == 0 ) {
+			// The cell is free. Claim it, unless another producer was faster.
+			if( compareSwap(&m_enqueuePos, pos, pos+1) ) {
+				break;
+			}
+		} else if( diff < 0 ) {
+			// The cell still holds a command the consumer has not read: full.
+			countDrop(&m_dropped);
+			return ERROR_CODE_QUEUE_FULL;
+		} else {
+			// Another producer claimed this position, try the next one.
+			pos = loadAcquire(&m_enqueuePos);
+		}
+	}
+
+	cell->cmd = cmd;
+	storeRelease(&cell->seq, pos+1);		// Publish the command to the consumer.
+	return ALL_OK;
+}
+
+// Enqueue a text write.
+uint8_t Seg7CommandQueue::pushWrite(uint8_t displays, const char* txt)
+{
+	seg7Command_t cmd;
+	uint8_t x = 0;
+	cmd.op  = SEG7_CMD_WRITE;
+	cmd.arg = displays;
+	cmd.time1 = cmd.time2 = 0;
+	for( ; x<sizeof(cmd.text) && txt[x]; x++) {
+		cmd.text[x] = txt[x];
+	}
+	for( ; x<sizeof(cmd.text); x++) {
+		cmd.text[x] = ' ';
+	}
+	return push(cmd);
+}
+
+// Enqueue a text write to a region. writeRegion() pads the region, so the text is ended with '\0'.
+uint8_t Seg7CommandQueue::pushWriteRegion(uint8_t row, uint8_t col, uint8_t width, uint8_t height, const char* txt)
+{
+	seg7Command_t cmd;
+	uint8_t x = 0;
+	cmd.op     = SEG7_CMD_WRITE_REGION;
+	cmd.arg    = 0;
+	cmd.row    = row;
+	cmd.col    = col;
+	cmd.width  = width;
+	cmd.height = height;
+	cmd.time1 = cmd.time2 = 0;
+	for( ; x<sizeof(cmd.text) && txt[x]; x++) {
+		cmd.text[x] = txt[x];
+	}
+	for( ; x<sizeof(cmd.text); x++) {
+		cmd.text[x] = '\0';
+	}
+	return push(cmd);
+}
+
+// Enqueue a decimal point update.
+uint8_t Seg7CommandQueue::pushDecimalPoints(uint8_t points)
+{
+	return pushOp(SEG7_CMD_DECIMAL_POINTS, points);
+}
+
+// Enqueue a blink setting.
+uint8_t Seg7CommandQueue::pushBlink(uint8_t digit, uint16_t on, uint16_t off)
+{
+	seg7Command_t cmd;
+	cmd.op    = SEG7_CMD_BLINK;
+	cmd.arg   = digit;
+	cmd.time1 = on;
+	cmd.time2 = off;
+	return push(cmd);
+}
+
+// Enqueue scrolling text. Unlike a write, short text is ended with '\0' so trailing spaces scroll too.
+uint8_t Seg7CommandQueue::pushScroll(uint8_t displays, const char* txt, uint16_t t, uint8_t left)
+{
+	seg7Command_t cmd;
+	uint8_t x = 0;
+	cmd.op    = SEG7_CMD_SCROLL;
+	cmd.arg   = displays;
+	cmd.time1 = t;
+	cmd.time2 = left;
+	for( ; x<sizeof(cmd.text) && txt[x]; x++) {
+		cmd.text[x] = txt[x];
+	}
+	for( ; x<sizeof(cmd.text); x++) {
+		cmd.text[x] = '\0';
+	}
+	return push(cmd);
+}
+
+// Enqueue a command without text.
+uint8_t Seg7CommandQueue::pushOp(uint8_t op, uint8_t arg)
+{
+	seg7Command_t cmd;
+	cmd.op  = op;
+	cmd.arg = arg;
+	cmd.time1 = cmd.time2 = 0;
+	return push(cmd);
+}
+
+// Dequeue one command. Only the consumer calls this.
+bool Seg7CommandQueue::pop(seg7Command_t& cmd)
+{
+	seg7QueuePos_t pos = m_dequeuePos;
+	cell_t* cell = &m_cells[pos & QUEUE_MASK];
+
+	if( (queueDiff_t)(seg7QueuePos_t)(loadAcquire(&cell->seq) - (seg7QueuePos_t)(pos+1)) < 0 ) {
+		return false;							// Nothing published yet.
+	}
+
+	cmd = cell->cmd;
+	storeRelease(&cell->seq, pos + SEG7_CMD_QUEUE_SIZE);	// Hand the cell back to the producers.
+	m_dequeuePos = pos + 1;
+	return true;
+}
@@ -0,0 +1,226 @@
+/**
+ * @file   Seg7CommandQueue.h
+ * @brief  Lock-free command queue for writing to a Seg7Display from several tasks.
+ *
+ * Several producers (RTOS tasks, threads or interrupt handlers) can enqueue fixed size
+ * display commands without blocking. The single consumer is Seg7Display::refresh(), which
+ * drains the queue and applies the commands before it scans the digits, so the display
+ * state is only ever changed from one place.
+ *
+ * Usage:
+ *
+ *		Seg7Display seg;
+ *		Seg7CommandQueue queue;
+ *
+ *		seg.attachQueue(&queue);		// In setup().
+ *		queue.pushWrite(DISPLAY_UPPER, "12.3");	// From any task.
+ *
+ * The queue is a bounded array of cells with per-cell sequence numbers. A producer claims
+ * a cell with one compare-and-swap on the enqueue position, fills it and then publishes it
+ * by storing the sequence number, so a command is never seen half written.
+ *
+ * @license
+ * ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ */
+
+#ifndef Seg7CommandQueue_h
+#define Seg7CommandQueue_h
+
+#include "Arduino.h"
+
+/*! \def SEG7_CMD_QUEUE_SIZE
+ *  \brief Number of commands the queue can hold. Must be a power of two, at most 64.
+ */
+#ifndef SEG7_CMD_QUEUE_SIZE
+#define SEG7_CMD_QUEUE_SIZE					8
+#endif
+
+/*! \def SEG7_CMD_TEXT_SIZE
+ *  \brief Size of the text in a command. Big enough for the whole framebuffer, at least 8.
+ */
+#ifndef SEG7_CMD_TEXT_SIZE
+#if defined(SEG7_MAX_DIGITS) && SEG7_MAX_DIGITS > 8
+#define SEG7_CMD_TEXT_SIZE					SEG7_MAX_DIGITS
+#else
+#define SEG7_CMD_TEXT_SIZE					8
+#endif
+#endif
+
+/*! \def SEG7_CMD_WRITE
+ *  \brief Write text to DISPLAY_UPPER, DISPLAY_LOWER or both (arg). Same as writeUpper/writeLower/writeSegments.
+ *
+ *  \def SEG7_CMD_WRITE_ONE
+ *  \brief Write text[0] to segment arg. Same as writeOneSegment.
+ *
+ *  \def SEG7_CMD_DECIMAL_POINTS
+ *  \brief Set the decimal points to arg. Same as setDecimalPoints.
+ *
+ *  \def SEG7_CMD_BLINK
+ *  \brief Blink the digits in arg with time1 on and time2 off. Same as setBlink.
+ *
+ *  \def SEG7_CMD_STOP_BLINK
+ *  \brief Stop blinking. Same as stopBlink.
+ *
+ *  \def SEG7_CMD_STOP_SCROLL
+ *  \brief Stop scrolling the displays in arg. Same as stopScroll.
+ *
+ *  \def SEG7_CMD_BAR_GRAPH
+ *  \brief Show a bar graph on the displays in arg with value time1 and max time2. Same as writeBarGraph.
+ *
+ *  \def SEG7_CMD_SCROLL
+ *  \brief Scroll text on DISPLAY_UPPER, DISPLAY_LOWER or both (arg), one step every time1 ms,
+ *  to the left when time2 is not 0. Same as scrollUpperEx/scrollLowerEx.
+ *
+ *  \def SEG7_CMD_WRITE_REGION
+ *  \brief Write text to the region at row, col of width by height digits. Same as writeRegion.
+ */
+#define SEG7_CMD_WRITE						1
+#define SEG7_CMD_WRITE_ONE					2
+#define SEG7_CMD_DECIMAL_POINTS				3
+#define SEG7_CMD_BLINK						4
+#define SEG7_CMD_STOP_BLINK					5
+#define SEG7_CMD_STOP_SCROLL				6
+#define SEG7_CMD_BAR_GRAPH					7
+#define SEG7_CMD_SCROLL						8
+#define SEG7_CMD_WRITE_REGION				9
+
+/*! \typedef seg7QueuePos_t
+ *  \brief Queue position and cell sequence number.
+ *
+ *  A producer that is preempted between reading the enqueue position and claiming it must
+ *  not find the position wrapped around to the same value, or it claims a cell that is still
+ *  in use. That takes 2^bits pushes by other producers while it is preempted, so positions
+ *  are 16 bits on AVR, where an RTOS task can be preempted too, and a full word elsewhere.
+ *  AVR cannot load or store 16 bits in one instruction, so the queue does it with
+ *  interrupts masked.
+ */
+#if defined(__AVR__)
+typedef uint16_t seg7QueuePos_t;
+#else
+typedef uint32_t seg7QueuePos_t;
+#endif
+
+/**
+ * \struct seg7Command
+ *
+ * One fixed size display command.
+ */
+typedef struct seg7Command {
+	uint8_t			op;			/*!< One of the SEG7_CMD_xxx codes. */
+	uint8_t			arg;		/*!< Display selection, digit mask, segment number or decimal points. */
+	uint8_t			row;		/*!< Top row for SEG7_CMD_WRITE_REGION. */
+	uint8_t			col;		/*!< Left column for SEG7_CMD_WRITE_REGION. */
+	uint8_t			width;		/*!< Digits per row for SEG7_CMD_WRITE_REGION. */
+	uint8_t			height;		/*!< Rows for SEG7_CMD_WRITE_REGION. */
+	uint16_t		time1;		/*!< Blink on time, scroll step time or bar graph value. */
+	uint16_t		time2;		/*!< Blink off time, scroll direction or bar graph max. */
+	char			text[SEG7_CMD_TEXT_SIZE];	/*!< Text for SEG7_CMD_WRITE and SEG7_CMD_WRITE_ONE padded with spaces, or for SEG7_CMD_SCROLL and SEG7_CMD_WRITE_REGION padded with '\0'. */
+}seg7Command_t;					/*!< typedef for structure seg7Command */
+
+/**
+ * \class Seg7CommandQueue
+ *
+ * \brief Bounded multi-producer, single-consumer lock-free queue of seg7Command_t.
+ *
+ * All push functions can be called from any task, thread or interrupt handler at the same
+ * time. They never block: when the queue is full the command is dropped, counted and
+ * ERROR_CODE_QUEUE_FULL is returned. pop() must only be called from one place, normally
+ * Seg7Display::refresh().
+ */
+class Seg7CommandQueue
+{
+	public:
+		//! Seg7CommandQueue default constructor. The queue starts empty.
+					Seg7CommandQueue();
+
+		//! Enqueues one command.
+		/*!
+		  \param [in] cmd is the command to copy into the queue.
+		  \return Returns ALL_OK on success, ERROR_CODE_QUEUE_FULL if the queue is full.
+	    */
+		uint8_t		push(const seg7Command_t& cmd);
+
+		//! Enqueues a text write.
+		/*!
+		  \param [in] displays can be DISPLAY_UPPER, DISPLAY_LOWER or both.
+		  \param [in] txt is the text to write. Only the characters that fit are used.
+		  \return Returns ALL_OK on success, ERROR_CODE_QUEUE_FULL if the queue is full.
+	    */
+		uint8_t		pushWrite(uint8_t displays, const char* txt);
+
+		//! Enqueues a text write to a rectangular region.
+		/*!
+		  \param [in] row is the top row of the region.
+		  \param [in] col is the left column of the region.
+		  \param [in] width is the number of digits per row in the region.
+		  \param [in] height is the number of rows in the region.
+		  \param [in] txt is the text, row-major. At most SEG7_CMD_TEXT_SIZE characters are used.
+		  \return Returns ALL_OK on success, ERROR_CODE_QUEUE_FULL if the queue is full.
+	    */
+		uint8_t		pushWriteRegion(uint8_t row, uint8_t col, uint8_t width, uint8_t height, const char* txt);
+
+		//! Enqueues a decimal point update.
+		/*!
+		  \param [in] points is the same as for Seg7Display::setDecimalPoints.
+		  \return Returns ALL_OK on success, ERROR_CODE_QUEUE_FULL if the queue is full.
+	    */
+		uint8_t		pushDecimalPoints(uint8_t points);
+
+		//! Enqueues a blink setting.
+		/*!
+		  \param [in] digit is the same as for Seg7Display::setBlink.
+		  \param [in] on is time in milliseconds that the digits is on.
+		  \param [in] off is time in milliseconds that the digits are off.
+		  \return Returns ALL_OK on success, ERROR_CODE_QUEUE_FULL if the queue is full.
+	    */
+		uint8_t		pushBlink(uint8_t digit, uint16_t on, uint16_t off);
+
+		//! Enqueues scrolling text.
+		/*!
+		  \param [in] displays can be DISPLAY_UPPER, DISPLAY_LOWER or both.
+		  \param [in] txt is the text to scroll. At most SEG7_CMD_TEXT_SIZE characters are used.
+		  \param [in] t is time in milliseconds between each scroll step.
+		  \param [in] left scrolls the text to the left when not 0.
+		  \return Returns ALL_OK on success, ERROR_CODE_QUEUE_FULL if the queue is full.
+	    */
+		uint8_t		pushScroll(uint8_t displays, const char* txt, uint16_t t, uint8_t left);
+
+		//! Enqueues a command without text (SEG7_CMD_STOP_BLINK, SEG7_CMD_STOP_SCROLL, ...).
+		/*!
+		  \param [in] op is the SEG7_CMD_xxx code.
+		  \param [in] arg is the command argument.
+		  \return Returns ALL_OK on success, ERROR_CODE_QUEUE_FULL if the queue is full.
+	    */
+		uint8_t		pushOp(uint8_t op, uint8_t arg);
+
+		//! Dequeues one command. Single consumer only.
+		/*!
+		  \param [out] cmd receives the command.
+		  \return Returns true if a command was dequeued, false if the queue was empty.
+	    */
+		bool		pop(seg7Command_t& cmd);
+
+		//! Number of commands dropped because the queue was full.
+		uint16_t	dropped() const { return m_dropped; }
+
+	private:	/// Stuff private to the class. Don't touch!
+		/// One queue slot. seq tells producers and the consumer whose turn it is.
+		typedef struct cell {
+			volatile seg7QueuePos_t	seq;
+			seg7Command_t		cmd;
+		}cell_t;
+
+		/// The queue slots.
+		cell_t				m_cells[SEG7_CMD_QUEUE_SIZE];
+
+		/// Next position to claim. Shared by all producers.
+		volatile seg7QueuePos_t	m_enqueuePos;
+
+		/// Next position to read. Only used by the consumer.
+		seg7QueuePos_t		m_dequeuePos;
+
+		/// Number of commands dropped because the queue was full.
+		volatile uint16_t	m_dropped;
+};
+
+#endif // Seg7CommandQueue_h
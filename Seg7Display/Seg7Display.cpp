@@ -10,22 +10,117 @@
 
 #include "SPI.h"
 #include <Seg7Display.h>
+#ifndef SEG7_NO_BOOT_FRAME
+#include <EEPROM.h>
+#endif
+
+// Boot frame layout in EEPROM, starting at SEG7_BOOT_FRAME_ADDR. Masks are stored low byte first.
+#define BOOT_MAGIC_0		'S'
+#define BOOT_MAGIC_1		'8'		// '7' was the fixed 2*4 digit layout.
+#define BOOT_OFS_SIZE		2		// m_segmentSize
+#define BOOT_OFS_ROWS		3		// m_disp.rows
+#define BOOT_OFS_COLS		4		// m_disp.cols
+#define BOOT_OFS_CODE		5		// m_disp.code[SEG7_MAX_DIGITS]
+#define BOOT_OFS_DPS		(BOOT_OFS_CODE + SEG7_MAX_DIGITS)		// m_dps
+#define BOOT_OFS_GROUPS		(BOOT_OFS_DPS + sizeof(seg7Mask_t))	// Number of blink groups n, then n * (members, on, off)
+#define BOOT_GROUP_SIZE		(4 + sizeof(seg7Mask_t))				// Checksum byte follows the last group.
+
+// EEPROM.update() skips unchanged bytes on AVR. ESP cores buffer in RAM and only commit what changed.
+#if defined(ESP8266) || defined(ESP32)
+#define BOOT_WRITE(a, v)	EEPROM.write(a, v)
+#else
+#define BOOT_WRITE(a, v)	EEPROM.update(a, v)
+#endif
+
+#ifndef SEG7_NO_BOOT_FRAME
+// Make sure EEPROM can hold the boot frame. ESP cores keep EEPROM in a RAM buffer that begin()
+// allocates, and begin() again drops the buffer, so it is only called when the sketch has not.
+static bool bootEepromReady()
+{
+#if defined(ESP8266) || defined(ESP32)
+	if( EEPROM.length() == 0 ) {
+		EEPROM.begin(SEG7_BOOT_FRAME_ADDR + SEG7_BOOT_FRAME_SIZE);
+	}
+#endif
+	return EEPROM.length() >= SEG7_BOOT_FRAME_ADDR + SEG7_BOOT_FRAME_SIZE;
+}
+#endif // SEG7_NO_BOOT_FRAME
+
+// Number of set bits, i.e. lit segments in a 7SEG code.
+static uint8_t bitCount(uint8_t v)
+{
+	uint8_t n = 0;
+	for( ; v; v &= v-1) {
+		n++;
+	}
+	return n;
+}
+
+#ifndef SEG7_NO_BOOT_FRAME
+// Store a digit mask in the boot frame buffer.
+static uint8_t bootPutMask(uint8_t* buf, seg7Mask_t mask)
+{
+	for( uint8_t b=0; b<sizeof(seg7Mask_t); b++) {
+		buf[b] = (uint8_t)(mask >> (8*b));
+	}
+	return sizeof(seg7Mask_t);
+}
+
+// Read a digit mask from the boot frame buffer.
+static seg7Mask_t bootGetMask(const uint8_t* buf)
+{
+	seg7Mask_t mask = 0;
+	for( uint8_t b=0; b<sizeof(seg7Mask_t); b++) {
+		mask |= (seg7Mask_t)buf[b] << (8*b);
+	}
+	return mask;
+}
+#endif // SEG7_NO_BOOT_FRAME
 
 // Standard constructor
 Seg7Display::Seg7Display()
 {
-	for(uint8_t i=0; i<8; i++ ) {
-		m_disp.upLo[i] 			= ' ';
-		m_blink.nextToggle[i]   = 0;
-		m_blink.isOn[i] 		= 1;
+	for(uint8_t i=0; i<SEG7_MAX_DIGITS; i++ ) {
+		m_disp.text[i] 			= ' ';
+		m_disp.code[i]			= 0x00;
+	}
+	m_disp.rows = 2;
+	m_disp.cols = 4;
+	for(uint8_t i=0; i<SEG7_BLINK_SLOTS; i++ ) {
+		m_blink.on[i] = m_blink.off[i] = m_blink.nextToggle[i] = 0;
+		m_blink.members[i] = 0x00;
 	}
-	m_disp.next  	= NULL;
-	m_blink.next 	= NULL;
+	m_blink.isOn	= 0x00;
+	m_blink.visible	= (seg7Mask_t)~0;
+	m_lastBlink		= 0;
+	m_booted		= 0;
 	m_ascii_table 	= NULL;
+	for(uint8_t i=0; i<SEG7_FONT_FALLBACKS; i++ ) {
+		m_fallback[i] = NULL;
+	}
+	m_fontRules = 0;
+	memset(m_font, 0, sizeof(m_font));
+	memset(m_fontOverride, 0, sizeof(m_fontOverride));
 	
 	m_segmentSize = 1;
-	m_scrollUpper.delay = m_scrollLower.delay = 0;
+	for(uint8_t i=0; i<SEG7_MAX_SCROLLS; i++ ) {
+		m_scroll[i].delay = 0;
+		m_scroll[i].source = NULL;
+		m_scroll[i].first = m_scroll[i].len = 0;
+	}
 	m_dps = 0;
+	m_blankZeros = 0;
+	m_cursor = 0;
+	m_cursorDot = 0;
+	m_cursorWrap = 0;
+	m_queue = NULL;
+	m_clock = millis;
+	m_bus = NULL;
+	m_busCtx = NULL;
+	m_segmentBudget = 0;
+	m_subFrames = 1;
+	memset(m_slotLoad, 0, sizeof(m_slotLoad));
+	memset(&m_coalesce, 0, sizeof(m_coalesce));
 	m_slaveSelectPin = 10;
 }
 
@@ -38,8 +133,6 @@ uint8_t Seg7Display::begin(uint8_t pin, const unsigned char *table)
 	
 	// Set the SlaveSelect pin
 	m_slaveSelectPin = pin;
-	// Set the ASCII 2 7SEG display table 
-	m_ascii_table = table;
 	
 	// Setup the SPI
 	pinMode(m_slaveSelectPin, OUTPUT);
@@ -47,13 +140,74 @@ uint8_t Seg7Display::begin(uint8_t pin, const unsigned char *table)
 	SPI.setBitOrder(LSBFIRST);
 	SPI.begin();
 	
+	// Show the saved boot frame as soon as the bus is up. Only at power-up: a later begin()
+	// that switches tables must not replace what the sketch has written since.
+	if( !m_booted ) {
+		m_booted = 1;
+		if( restoreBootFrame() ) {
+			refresh();
+		}
+	}
+	
+	// Set the ASCII 2 7SEG display table and decode what is already in the buffer with it.
+	// A restored frame is already encoded and has no text to decode.
+	m_ascii_table = table;
+	helperFontResolve();
+	
+	return ALL_OK;
+}
+
+// Add a fallback table for characters the begin() table does not have.
+uint8_t Seg7Display::addFallbackTable(const unsigned char *table)
+{
+	for( uint8_t i=0; i<SEG7_FONT_FALLBACKS; i++) {
+		if( !m_fallback[i] ) {
+			m_fallback[i] = table;
+			helperFontResolve();
+			return ALL_OK;
+		}
+	}
+	return ERROR_CODE_OUT_OF_RANGE;
+}
+
+// Set the substitution rules for missing characters.
+void Seg7Display::setFontRules(uint8_t rules)
+{
+	m_fontRules = rules;
+	helperFontResolve();
+}
+
+// Override the 7SEG code of one character.
+uint8_t Seg7Display::setGlyph(char ch, uint8_t code)
+{
+	uint8_t c = (uint8_t)ch;
+	if( c >= SEG7_FONT_SIZE ) {
+		return ERROR_CODE_OUT_OF_RANGE;
+	}
+	m_fontOverride[c>>3] |= 0x80 >> (c&7);
+	m_font[c] = code;
+	helperFontResolve();
 	return ALL_OK;
 }
 
+// Remove all fallback tables, rules and overrides.
+void Seg7Display::resetFont()
+{
+	for( uint8_t i=0; i<SEG7_FONT_FALLBACKS; i++) {
+		m_fallback[i] = NULL;
+	}
+	m_fontRules = 0;
+	memset(m_fontOverride, 0, sizeof(m_fontOverride));
+	helperFontResolve();
+}
+
 /// setSegmentsSize sets the number of display segments available.
 uint8_t Seg7Display::setSegmentsArraySize(uint8_t size)
 {
 	// There must be at least one 7SEG display 
+	if( size > SEG7_MAX_DIGITS ) {
+		return ERROR_CODE_OUT_OF_RANGE;
+	}
 	if( size > 0) {
 		m_segmentSize = size; 
 		return ALL_OK;
@@ -62,22 +216,77 @@ uint8_t Seg7Display::setSegmentsArraySize(uint8_t size)
 	return ERROR_CODE_TO_FEW_SEGMENTS;
 }
 
- // writeSegments writes a String to both upper and lower displays.
+// setGeometry sets the framebuffer size. Scrolls set up for the old size are stopped.
+uint8_t Seg7Display::setGeometry(uint8_t rows, uint8_t cols)
+{
+	uint16_t size = (uint16_t)rows * cols;
+	if( size == 0 || size > SEG7_MAX_DIGITS ) {
+		return ERROR_CODE_OUT_OF_RANGE;
+	}
+	
+	m_disp.rows = rows;
+	m_disp.cols = cols;
+	m_segmentSize = size;
+	for( uint8_t s=0; s<SEG7_MAX_SCROLLS; s++) {
+		m_scroll[s].delay = 0;
+		m_scroll[s].source = NULL;
+	}
+	return ALL_OK;
+}
+
+// Write text to a rectangular region, row by row.
+uint8_t Seg7Display::writeRegion(uint8_t row, uint8_t col, uint8_t width, uint8_t height, const char* txt)
+{
+	if( !helperRegionMask(row, col, width, height) ) {
+		return ERROR_CODE_OUT_OF_RANGE;
+	}
+	
+	unsigned int n = strlen(txt);
+	uint8_t first = row * m_disp.cols + col;
+	
+	// Whole rows are contiguous in the framebuffer, so they are one span.
+	if( width == m_disp.cols ) {
+		helperWrite(txt, n, first, width * height);
+		return ALL_OK;
+	}
+	
+	for( uint8_t r=0; r<height; r++, first += m_disp.cols) {
+		unsigned int ofs = (unsigned int)r * width;
+		if( ofs < n ) {
+			helperWrite(txt + ofs, n - ofs, first, width);
+		} else {
+			helperWrite(txt, 0, first, width);
+		}
+	}
+	return ALL_OK;
+}
+
+// Write text to one whole row.
+uint8_t Seg7Display::writeRow(uint8_t row, const char* txt)
+{
+	return writeRegion(row, 0, m_disp.cols, 1, txt);
+}
+
+ // writeSegments writes a String to the whole framebuffer.
 void Seg7Display::writeSegments(String txt)
 {
-	helperWrite(txt, m_disp.upLo, 8);
+	helperWrite(txt.c_str(), txt.length(), 0, m_disp.rows * m_disp.cols);
 }
 
 // Write a string to the upper segments
 void Seg7Display::writeUpper(String txt)
 {
-	helperWrite(txt, m_disp.upper, 4);
+	uint8_t first;
+	uint8_t len = helperRow(DISPLAY_UPPER, first);
+	helperWrite(txt.c_str(), txt.length(), first, len);
 }
 
 // Write a string to the lower segments
 void Seg7Display::writeLower(String txt)
 {
-	helperWrite(txt, m_disp.lower, 4);
+	uint8_t first;
+	uint8_t len = helperRow(DISPLAY_LOWER, first);
+	helperWrite(txt.c_str(), txt.length(), first, len);
 }
 
 // writeSegment writes one character to one display segment.
@@ -91,7 +300,7 @@ uint8_t Seg7Display::writeOneSegment(uint8_t seg, char ch)
 	/* If the current display buffer is to small, then pad with spaces ' ' until
 	 * we can add the ch parameter at the right String position.
 	 */
-	m_disp.upLo[seg-1] = ch;
+	helperSetDigit(seg-1, ch);
 	 
 	// Make a refresh to display the character(s) we just added to the String buffer.
 	refresh();
@@ -105,141 +314,702 @@ uint8_t Seg7Display::writeOneSegment(uint8_t seg, char ch)
  */
 uint8_t Seg7Display::readOneSegment(uint8_t seg, char& ch)
 {
-	if( seg > 8 ) {
+	if( seg >= SEG7_MAX_DIGITS ) {
 		ch = '\0';
 		return ERROR_CODE_OUT_OF_RANGE;
 	}
 	
-	ch = m_disp.upLo[seg];
+	ch = helperText(seg);
 	return ALL_OK;
 }
 
 // refresh can be used to refresh the 7SEG displays.
 void Seg7Display::refresh()
 {
-	uint8_t dp = 0x80;						// Helper variable for decimal point write.
-	unsigned long thisTime = millis();		// What time is it now?
+	SEG7_TRACE_SCOPE(SEG7_TRACE_REFRESH);
+	uint8_t codes[SEG7_MODULES];			// One code per module for the current scan slot.
+	unsigned long now = m_clock();
+	uint16_t thisTime = now;				// What time is it now? Low 16 bits are enough for the rest.
+	seg7Command_t cmd;
 	
-	// Check if we are scrolling the upper row.
-	if( m_scrollUpper.delay ) {
-		helperScroll(m_scrollUpper, &m_disp.upper[0]);
+	// Apply what other tasks have queued for us.
+	if( m_queue ) {
+		while( m_queue->pop(cmd) ) {
+			applyCommand(cmd);
+		}
+	}
+	
+	// Apply coalesced writes at most once per minInterval.
+	if( (m_coalesce.pending || m_coalesce.dpsPending)
+		&& (uint16_t)(thisTime - m_coalesce.lastApply) >= m_coalesce.minInterval ) {
+		helperApplyPending();
+		m_coalesce.lastApply = thisTime;
+		m_coalesce.applied++;
 	}
 	
-	// Check if we are scrolling the lower row.
-	if( m_scrollLower.delay ) {
-		helperScroll(m_scrollLower, &m_disp.lower[0]);
+	// Step the regions that are scrolling.
+	for( uint8_t s=0; s<SEG7_MAX_SCROLLS; s++) {
+		if( m_scroll[s].delay ) {
+			helperScroll(m_scroll[s]);
+		}
 	}
 	
-	// Loop through all the digits in our array.
-	for( uint8_t i=0; i<m_segmentSize; i++)
+	// Toggle the blink groups that are past their deadline.
+	helperBlink(now);
+	
+	// Digit i is in slot i%8 of module i/8. One frame per slot updates that slot in every module.
+	uint8_t modules = (m_segmentSize + 7) / 8;
+	uint8_t slots = (m_segmentSize < 8) ? m_segmentSize : 8;
+	if( m_segmentBudget ) {
+		helperScanBudget(slots, modules);
+		return;
+	}
+	for( uint8_t i=0; i<slots; i++)
 	{
-	  // Check if any of the digits are in blink mode
-	  if( m_blink.nextToggle[i] && (m_blink.nextToggle[i]<thisTime)) {
-		  
-		  // Yes, we are blinking digit i, so we just toggle it (on/off) ...
-		  m_blink.isOn[i] = m_blink.isOn[i]?0:1;
-		  
-		  // ... and set the next toggle interval.
-		  if( m_blink.isOn[i] ) {
-			  m_blink.nextToggle[i] = m_blink.on[i] + thisTime;
-		  } else {
-			  m_blink.nextToggle[i] = m_blink.off[i] + thisTime;
-		  }
+	  uint8_t lit = 0;
+	  for( uint8_t m=0; m<modules; m++)
+	  {
+		  codes[m] = helperGlyph(m*8 + i);
+		  lit += bitCount(codes[m]);
 	  }
-	  
-	  // m_blink.isOn[i] is always 1 when not blinking, and 0 or 1 when in blinking mode.
-	  if( m_blink.isOn[i] ) {
-		  /** spi_packet:  bits 8-15 = 7SEG code for character to print on the display
-		   *               bits 0-7  = code for which 7SEG to update. 0x80 = upper left, 0x01 = lower right.
-		   */
-		   
-		   sendSPImessage( asciiTo7seg(m_disp.upLo[i]) | ((m_dps & dp)?0x01:0x00), 0x80>>i);
-	  } else {
-		  // Transfer a zero to digit i.
-		   sendSPImessage( 0x00, 0x80>>i);
-	  }
-	  
-	  dp = dp>>1;			// Check if next decimal point is on or not.
+	  m_slotLoad[i] = lit;
+	  sendSPImessage(codes, modules, 0x80>>i);
 	}
+	m_subFrames = 1;
 }
 
-void Seg7Display::sendSPImessage(unsigned char ch, unsigned char pos)
+// Scan with at most m_segmentBudget segments lit in any frame.
+void Seg7Display::helperScanBudget(uint8_t slots, uint8_t modules)
 {
-	// Transfer two bytes over SPI.
+	// Zeroed, the compiler cannot tell that modules is at most SEG7_MODULES.
+	uint8_t codes[SEG7_MODULES] = { 0 };
+	uint8_t sub[SEG7_MODULES] = { 0 };
+	uint8_t k = 1;
+	
+	// Every slot gets the same number of sub-frames, enough for the heaviest slot,
+	// so every lit segment is on for the same share of the scan.
+	for( uint8_t i=0; i<slots; i++) {
+		uint8_t lit = 0;
+		for( uint8_t m=0; m<modules; m++) {
+			lit += bitCount(helperGlyph(m*8 + i));
+		}
+		uint8_t need = (lit + m_segmentBudget - 1) / m_segmentBudget;
+		k = (need > k) ? need : k;
+	}
+	
+	for( uint8_t i=0; i<slots; i++) {
+		for( uint8_t m=0; m<modules; m++) {
+			codes[m] = helperGlyph(m*8 + i);
+		}
+		m_slotLoad[i] = 0;
+		for( uint8_t f=0; f<k; f++) {
+			// Deal the lit segments of the slot round-robin: the n:th one goes to sub-frame n%k.
+			uint8_t n = 0;
+			uint8_t lit = 0;
+			for( uint8_t m=0; m<modules; m++) {
+				sub[m] = 0;
+				for( uint8_t bit=0x80; bit; bit>>=1) {
+					if( codes[m] & bit ) {
+						if( n % k == f ) {
+							sub[m] |= bit;
+							lit++;
+						}
+						n++;
+					}
+				}
+			}
+			m_slotLoad[i] = (lit > m_slotLoad[i]) ? lit : m_slotLoad[i];
+			sendSPImessage(sub, modules, 0x80>>i);
+		}
+	}
+	m_subFrames = k;
+}
+
+void Seg7Display::sendSPImessage(const uint8_t* codes, uint8_t modules, unsigned char pos)
+{
+	SEG7_TRACE_SCOPE(SEG7_TRACE_SPI);
+	/** spi_packet:  bits 8-15 = 7SEG code for character to print on the display
+	 *               bits 0-7  = code for which 7SEG to update. 0x80 = upper left, 0x01 = lower right.
+	 * The word for the last module in the chain goes out first, so module 0 gets the last word.
+	 */
+	if( m_bus ) {
+		uint16_t words[SEG7_MODULES];
+		for( uint8_t m=modules, x=0; m--; x++) {
+			words[x] = codes[m]<<8 | pos;
+		}
+		m_bus(m_busCtx, words, modules);
+		return;
+	}
+	
 	digitalWrite(m_slaveSelectPin, LOW);
-	SPI.transfer16(ch<<8 | pos);
+	for( uint8_t m=modules; m--; ) {
+		SPI.transfer16(codes[m]<<8 | pos);
+	}
 	digitalWrite(m_slaveSelectPin, HIGH);
 }
 
+// Get the code digit d shows right now.
+uint8_t Seg7Display::helperGlyph(uint8_t d)
+{
+	seg7Mask_t dp = SEG7_DIGIT_BIT(d);
+	// The visible bit is always set when not blinking, and set or cleared when in blinking mode.
+	if( d < m_segmentSize && (m_blink.visible & dp) ) {
+		return m_disp.code[d] | ((m_dps & dp)?0x01:0x00);
+	}
+	return 0x00;				// Transfer a zero to digit d.
+}
+
 // Call this function to set up scrolling text for the upper display.
 void Seg7Display::scrollUpperEx(String str, unsigned int t, uint8_t left)
 {
-	helperSetupScroll(str, m_scrollUpper, m_disp.upper, t, left);
+	scrollRegionEx(0, 0, m_disp.cols, str, t, left);
 }
 
 // Call this function to set up scrolling text for the upper display.
 void Seg7Display::scrollUpper(unsigned int t, uint8_t left)
 {
-	String str = m_disp.upper;
-	str.remove(4);
-	scrollUpperEx( str, t, left);
+	char buf[SEG7_MAX_DIGITS+1];
+	uint8_t first;
+	uint8_t len = helperRow(DISPLAY_UPPER, first);
+	for( uint8_t x=0; x<len; x++) {
+		buf[x] = helperText(first + x);
+	}
+	buf[len] = '\0';
+	scrollUpperEx( buf, t, left);
 }
 
 // Call this function to set up scrolling text for the lower display.
 void Seg7Display::scrollLowerEx(String str, unsigned int t, uint8_t left)
 {
-	helperSetupScroll(str, m_scrollLower, m_disp.lower, t, left);
+	scrollRegionEx(1, 0, m_disp.cols, str, t, left);
 }
 
 // Call this function to set up scrolling text for the lower display.
 void Seg7Display::scrollLower(unsigned int t, uint8_t left)
 {
-	String str = m_disp.lower;
-	str.remove(4);
-	scrollLowerEx( m_disp.lower, t, left);
+	char buf[SEG7_MAX_DIGITS+1];
+	uint8_t first;
+	uint8_t len = helperRow(DISPLAY_LOWER, first);
+	for( uint8_t x=0; x<len; x++) {
+		buf[x] = helperText(first + x);
+	}
+	buf[len] = '\0';
+	scrollLowerEx( buf, t, left);
+}
+
+// Call this function to scroll characters pulled from a callback on the upper display.
+void Seg7Display::scrollUpperStream(scrollSource_t src, void* ctx, unsigned int t, uint8_t left)
+{
+	scrollRegionStream(0, 0, m_disp.cols, src, ctx, t, left);
+}
+
+// Call this function to scroll characters pulled from a callback on the lower display.
+void Seg7Display::scrollLowerStream(scrollSource_t src, void* ctx, unsigned int t, uint8_t left)
+{
+	scrollRegionStream(1, 0, m_disp.cols, src, ctx, t, left);
+}
+
+// Call this function to scroll a text in a region of one row.
+uint8_t Seg7Display::scrollRegionEx(uint8_t row, uint8_t col, uint8_t width, String str, unsigned int t, uint8_t left)
+{
+	scroll_t* scroll = helperSetupScroll(row, col, width);
+	if( !scroll ) {
+		return ERROR_CODE_OUT_OF_RANGE;
+	}
+	scroll->source = NULL;
+	scroll->text = str;
+	scroll->delay = (t > SEG7_MAX_SCROLL_DELAY) ? SEG7_MAX_SCROLL_DELAY : t;
+	scroll->time = m_clock();
+	scroll->toLeft = left;
+	scroll->marker = left?0:str.length()-1;
+	return ALL_OK;
+}
+
+// Call this function to scroll characters pulled from a callback in a region of one row.
+uint8_t Seg7Display::scrollRegionStream(uint8_t row, uint8_t col, uint8_t width, scrollSource_t src, void* ctx, unsigned int t, uint8_t left)
+{
+	scroll_t* scroll = helperSetupScroll(row, col, width);
+	if( !scroll ) {
+		return ERROR_CODE_OUT_OF_RANGE;
+	}
+	scroll->text = (const char*)NULL;	// Free the text of an earlier scroll. "" would keep its buffer.
+	scroll->source = src;
+	scroll->ctx = ctx;
+	scroll->delay = (t > SEG7_MAX_SCROLL_DELAY) ? SEG7_MAX_SCROLL_DELAY : t;
+	scroll->time = m_clock();
+	scroll->toLeft = left;
+	scroll->marker = 0;
+	return ALL_OK;
+}
+
+// Stop the scroll of the region starting at row and col.
+void Seg7Display::stopScrollRegion(uint8_t row, uint8_t col)
+{
+	uint8_t first = row * m_disp.cols + col;
+	for( uint8_t s=0; s<SEG7_MAX_SCROLLS; s++) {
+		if( m_scroll[s].delay && m_scroll[s].first == first ) {
+			m_scroll[s].delay = 0;
+			m_scroll[s].source = NULL;
+		}
+	}
+}
+
+// Print one character at the cursor.
+size_t Seg7Display::write(uint8_t ch)
+{
+	return helperPrint(ch);
+}
+
+// Print a run of characters at the cursor, straight into the framebuffer.
+size_t Seg7Display::write(const uint8_t *buf, size_t size)
+{
+	size_t n = 0;
+	while( n<size && helperPrint(buf[n]) ) {
+		n++;
+	}
+	return n;
+}
+
+// Move the print cursor.
+uint8_t Seg7Display::setCursor(uint8_t row, uint8_t col)
+{
+	if( !helperRegionMask(row, col, 1, 1) ) {
+		return ERROR_CODE_OUT_OF_RANGE;
+	}
+	m_cursor = row * m_disp.cols + col;
+	m_cursorDot = 0;
+	m_cursorWrap = 0;
+	return ALL_OK;
+}
+
+// Blank the framebuffer and move the print cursor home.
+void Seg7Display::clear()
+{
+	helperWrite("", 0, 0, m_disp.rows * m_disp.cols);
+	helperSetDps((seg7Mask_t)~0, 0);
+	m_cursor = 0;
+	m_cursorDot = 0;
+	m_cursorWrap = 0;
+}
+
+// Call this function to scroll characters from a ring buffer on the upper display.
+void Seg7Display::scrollUpperRing(scrollRing_t& ring, unsigned int t, uint8_t left)
+{
+	scrollUpperStream(ringPull, &ring, t, left);
+}
+
+// Call this function to scroll characters from a ring buffer on the lower display.
+void Seg7Display::scrollLowerRing(scrollRing_t& ring, unsigned int t, uint8_t left)
+{
+	scrollLowerStream(ringPull, &ring, t, left);
+}
+
+// Set up an empty ring buffer on caller supplied storage.
+void Seg7Display::ringInit(scrollRing_t& ring, char* buf, uint8_t size)
+{
+	ring.buf  = buf;
+	ring.size = size;
+	ring.head = ring.tail = 0;
+}
+
+// Add one character to a ring buffer. Only the producer calls this.
+uint8_t Seg7Display::ringPush(scrollRing_t& ring, char ch)
+{
+	uint8_t next = ring.head + 1;
+	if( next >= ring.size ) {
+		next = 0;
+	}
+	if( next == ring.tail ) {
+		return ERROR_CODE_OUT_OF_RANGE;		// Full, the character is dropped.
+	}
+	ring.buf[ring.head] = ch;
+	ring.head = next;						// Publish after the character is stored.
+	return ALL_OK;
+}
+
+// Remove one character from a ring buffer. Only the scroll (consumer) calls this.
+int Seg7Display::ringPull(void* ring)
+{
+	scrollRing_t& r = *(scrollRing_t*)ring;
+	uint8_t tail = r.tail;
+	if( tail == r.head ) {
+		return -1;							// Empty, the scroll waits for more data.
+	}
+	int ch = (unsigned char)r.buf[tail];
+	r.tail = (tail + 1 >= r.size) ? 0 : tail + 1;
+	return ch;
 }
 
 // Sets the m_bps member variable to the digits with decimal point set.
 void Seg7Display::setDecimalPoints(uint8_t points)
 {
-	m_dps = points;
+	// The 8 bit mask replaces the points of the first 8 digits only.
+	helperSetDps(helperLegacyMask(0xFF), helperLegacyMask(points));
+}
+
+// Set or clear the decimal point of one digit.
+uint8_t Seg7Display::setDecimalPoint(uint8_t row, uint8_t col, uint8_t on)
+{
+	seg7Mask_t mask = helperRegionMask(row, col, 1, 1);
+	if( !mask ) {
+		return ERROR_CODE_OUT_OF_RANGE;
+	}
+	helperSetDps(mask, on ? mask : 0);
+	return ALL_OK;
 }
 
 // Set what digits should blink and the time interval.
 void Seg7Display::setBlink(uint8_t digit, unsigned int on, unsigned int off)
 {
-	uint8_t i = 0;
-	millis();
-	delay(100);
-	unsigned long t = millis();
-	for( uint8_t x = 0x80; x; x = x>>1) {
-		if( x & digit ) {
-			m_blink.on[i]			= on;
-			m_blink.off[i]			= off;
-			m_blink.nextToggle[i]	= t;
-			m_blink.isOn[i]			= 0;
+	// New blink groups start dark and turn on at the first refresh() after this millisecond,
+	// as they did when this returned from a delay(100), but without blocking the caller.
+	helperSetBlink(helperLegacyMask(digit), on, off, m_clock());
+}
+
+// Blink a rectangular region.
+uint8_t Seg7Display::setBlinkRegion(uint8_t row, uint8_t col, uint8_t width, uint8_t height, unsigned int on, unsigned int off)
+{
+	seg7Mask_t mask = helperRegionMask(row, col, width, height);
+	if( !mask ) {
+		return ERROR_CODE_OUT_OF_RANGE;
+	}
+	helperSetBlink(mask, on, off, m_clock());
+	return ALL_OK;
+}
+
+// Encode a span of characters to 7SEG codes.
+void Seg7Display::encode(const char* txt, unsigned int len, uint8_t* out)
+{
+	// One range check and one cache load per character.
+	for( unsigned int i=0; i<len; i++) {
+		uint8_t c = (uint8_t)txt[i];
+		out[i] = (c < SEG7_FONT_SIZE) ? m_font[c] : 0;
+	}
+}
+
+// Show a horizontal bar graph with two steps per digit.
+void Seg7Display::writeBarGraph(uint8_t displays, uint16_t value, uint16_t max)
+{
+	uint8_t first;
+	uint8_t len = helperRow(displays, first);
+	if( !len || !max ) {
+		return;
+	}
+	
+	// Number of lit bars, rounded to the nearest step.
+	uint8_t steps = len * 2;
+	uint8_t lit = (value >= max) ? steps : (uint8_t)(((uint32_t)value * steps + max/2) / max);
+	
+	for( uint8_t x=0; x<len; x++) {
+		uint8_t code = 0x00;
+		if( lit >= 2 ) {
+			code = SYM_BAR_L | SYM_BAR_R;
+			lit -= 2;
+		} else if( lit ) {
+			code = SYM_BAR_L;
+			lit = 0;
+		}
+		helperWriteCode(first + x, code);
+	}
+}
+
+// Show one vertical level (0..3 horizontal segments) per digit.
+void Seg7Display::writeLevels(uint8_t displays, const uint16_t* values, uint16_t max)
+{
+	static const uint8_t levels[4] = { 0x00, SYM_D, SYM_D | SYM_G, SYM_D | SYM_G | SYM_A };
+	uint8_t first;
+	uint8_t len = helperRow(displays, first);
+	if( !max ) {
+		return;
+	}
+	
+	for( uint8_t x=0; x<len; x++) {
+		uint8_t n = (values[x] >= max) ? 3 : (uint8_t)(((uint32_t)values[x] * 3 + max/2) / max);
+		helperWriteCode(first + x, levels[n]);
+	}
+}
+
+// Write a decimal counter value. The digits hold the counter state from here on.
+uint8_t Seg7Display::writeCounter(uint8_t displays, unsigned long value, uint8_t zeroPad)
+{
+	uint8_t first;
+	uint8_t len = helperRow(displays, first);
+	if( !len ) {
+		return ERROR_CODE_OUT_OF_RANGE;
+	}
+	
+	if( zeroPad ) {
+		m_blankZeros &= ~displays;
+	} else {
+		m_blankZeros |= displays;
+	}
+	
+	for( uint8_t x=len; x--; ) {
+		char ch = (value || zeroPad || x==len-1) ? '0' + value%10 : ' ';
+		helperSetDigit(first + x, ch);
+		value /= 10;
+	}
+	return ALL_OK;
+}
+
+// Add one to the counter, touching only the digits the carry reaches.
+void Seg7Display::countUp(uint8_t displays)
+{
+	uint8_t first;
+	uint8_t len = helperRow(displays, first);
+	
+	for( uint8_t i=first+len; i-- > first; ) {
+		char ch = helperText(i);
+		if( ch == '9' ) {
+			helperSetDigit(i, '0');					// Carry to the next digit.
+			continue;
+		}
+		// A blank (leading) digit counts as zero.
+		helperSetDigit(i, (ch>='0' && ch<'9') ? ch+1 : '1');
+		return;
+	}
+	
+	// Overflow: all digits are zero now, blank the leading ones if asked to.
+	if( len && (m_blankZeros & displays) ) {
+		for( uint8_t i=first; i<first+len-1; i++) {
+			helperSetDigit(i, ' ');
+		}
+	}
+}
+
+// Subtract one from the counter, touching only the digits the borrow reaches.
+void Seg7Display::countDown(uint8_t displays)
+{
+	uint8_t first;
+	uint8_t len = helperRow(displays, first);
+	uint8_t last = first + len - 1;
+	
+	for( uint8_t i=first+len; i-- > first; ) {
+		char ch = helperText(i);
+		if( ch>'0' && ch<='9' ) {
+			ch--;
+			// Blank a new leading zero, but never the last digit.
+			if( ch=='0' && i!=last && (m_blankZeros & displays) && (i==first || helperText(i-1)==' ') ) {
+				ch = ' ';
+			}
+			helperSetDigit(i, ch);
+			return;
+		}
+		helperSetDigit(i, '9');						// Borrow from the next digit.
+	}
+}
+
+// Write HH.MM.SS (8 digits) or MM.SS (4 digits) with decimal points as separators.
+uint8_t Seg7Display::writeClock(uint8_t displays, uint8_t hours, uint8_t minutes, uint8_t seconds)
+{
+	uint8_t first;
+	uint8_t len = helperRow(displays, first);
+	if( len<4 || hours>23 || minutes>59 || seconds>59 ) {
+		return ERROR_CODE_OUT_OF_RANGE;
+	}
+	
+	uint8_t last = first + len - 1;
+	helperSetDigit(last,   '0' + seconds%10);
+	helperSetDigit(last-1, '0' + seconds/10);
+	helperSetDigit(last-2, '0' + minutes%10);
+	helperSetDigit(last-3, '0' + minutes/10);
+	
+	// The decimal points of the span are the separator(s).
+	seg7Mask_t dps = SEG7_DIGIT_BIT(last-2);
+	
+	if( len >= 6 ) {
+		helperSetDigit(last-4, '0' + hours%10);
+		helperSetDigit(last-5, '0' + hours/10);
+		for( uint8_t i=first; i<last-5; i++) {
+			helperSetDigit(i, ' ');
+		}
+		dps |= SEG7_DIGIT_BIT(last-4);
+	}
+	helperWriteDps(helperSpanMask(first, len), dps);
+	return ALL_OK;
+}
+
+// Advance the clock one second, touching only the digits the carry reaches.
+void Seg7Display::clockTick(uint8_t displays)
+{
+	// Largest value of each clock digit, counted from the right: S, 10S, M, 10M, H, 10H.
+	static const char top[6] = { '9', '5', '9', '5', '9', '2' };
+	uint8_t first;
+	uint8_t len = helperRow(displays, first);
+	if( len < 4 ) {
+		return;
+	}
+	
+	uint8_t last = first + len - 1;
+	uint8_t n = (len >= 6) ? 6 : 4;
+	for( uint8_t k=0; k<n; k++) {
+		uint8_t i = last - k;
+		char ch = helperText(i);
+		char max = (k==4 && helperText(i-1)=='2') ? '3' : top[k];
+		if( ch < max ) {
+			helperSetDigit(i, ch + 1);
+			return;
+		}
+		helperSetDigit(i, '0');						// Carry to the next digit.
+	}
+}
+
+// Move the clock back one second, touching only the digits the borrow reaches.
+void Seg7Display::clockTickDown(uint8_t displays)
+{
+	static const char top[6] = { '9', '5', '9', '5', '9', '2' };
+	uint8_t first;
+	uint8_t len = helperRow(displays, first);
+	if( len < 4 ) {
+		return;
+	}
+	
+	uint8_t last = first + len - 1;
+	uint8_t n = (len >= 6) ? 6 : 4;
+	for( uint8_t k=0; k<n; k++) {
+		uint8_t i = last - k;
+		char ch = helperText(i);
+		if( ch > '0' ) {
+			helperSetDigit(i, ch - 1);
+			return;
 		}
-		i++;
+		// Borrow. Hours go from 00 to 23, and x0 to (x-1)9 otherwise.
+		helperSetDigit(i, (k==4 && helperText(i-1)=='0') ? '3' : top[k]);
+	}
+}
+
+// Save the current frame as the boot frame.
+uint8_t Seg7Display::saveBootFrame()
+{
+#ifndef SEG7_NO_BOOT_FRAME
+	uint8_t buf[SEG7_BOOT_FRAME_SIZE];
+	uint8_t n = BOOT_OFS_GROUPS + 1;
+	uint8_t sum = 0;
+	
+	buf[0] = BOOT_MAGIC_0;
+	buf[1] = BOOT_MAGIC_1;
+	buf[BOOT_OFS_SIZE] = m_segmentSize;
+	buf[BOOT_OFS_ROWS] = m_disp.rows;
+	buf[BOOT_OFS_COLS] = m_disp.cols;
+	memcpy(buf + BOOT_OFS_CODE, m_disp.code, SEG7_MAX_DIGITS);
+	bootPutMask(buf + BOOT_OFS_DPS, m_dps);
+	buf[BOOT_OFS_GROUPS] = 0;
+	for( uint8_t g=0; g<SEG7_BLINK_SLOTS; g++) {
+		if( m_blink.members[g] ) {
+			n += bootPutMask(buf + n, m_blink.members[g]);
+			buf[n++] = m_blink.on[g] & 0xFF;
+			buf[n++] = m_blink.on[g] >> 8;
+			buf[n++] = m_blink.off[g] & 0xFF;
+			buf[n++] = m_blink.off[g] >> 8;
+			buf[BOOT_OFS_GROUPS]++;
+		}
+	}
+	for( uint8_t x=0; x<n; x++) {
+		sum += buf[x];
+	}
+	buf[n++] = ~sum;
+	
+	if( !bootEepromReady() ) {
+		return ERROR_CODE_EEPROM_SIZE;
+	}
+	for( uint8_t x=0; x<n; x++) {
+		BOOT_WRITE(SEG7_BOOT_FRAME_ADDR + x, buf[x]);
+	}
+#if defined(ESP8266) || defined(ESP32)
+	EEPROM.commit();
+#endif
+#endif // SEG7_NO_BOOT_FRAME
+	return ALL_OK;
+}
+
+// Remove the boot frame. Breaking the magic is enough.
+void Seg7Display::clearBootFrame()
+{
+#ifndef SEG7_NO_BOOT_FRAME
+	if( !bootEepromReady() ) {
+		return;
+	}
+	BOOT_WRITE(SEG7_BOOT_FRAME_ADDR, 0xFF);
+#if defined(ESP8266) || defined(ESP32)
+	EEPROM.commit();
+#endif
+#endif // SEG7_NO_BOOT_FRAME
+}
+
+// Turn update coalescing on or off.
+void Seg7Display::setMaxUpdateRate(uint16_t minInterval)
+{
+	m_coalesce.minInterval = minInterval;
+	if( !minInterval ) {
+		helperApplyPending();			// Nothing may stay pending when coalescing is off.
+	}
+	// Let the first coalesced update through at the next refresh().
+	m_coalesce.lastApply = (uint16_t)m_clock() - minInterval;
+}
+
+// Set the time source used for all scroll, blink and coalescing timing.
+void Seg7Display::setClock(seg7Clock_t clock)
+{
+	m_clock = clock ? clock : millis;
+}
+
+// Attach a command queue that refresh() drains.
+void Seg7Display::attachQueue(Seg7CommandQueue* queue)
+{
+	m_queue = queue;
+}
+
+// Send the refresh() frames to a hook instead of the SPI bus.
+void Seg7Display::setBus(seg7Bus_t bus, void* ctx)
+{
+	m_bus = bus;
+	m_busCtx = ctx;
+}
+
+// Cap the number of segments lit at the same time.
+void Seg7Display::setSegmentBudget(uint8_t maxLit)
+{
+	m_segmentBudget = maxLit;
+}
+
+// Report the segment load per scan slot of the last refresh().
+uint8_t Seg7Display::readSegmentLoad(uint8_t* load, uint8_t max)
+{
+	uint8_t slots = (m_segmentSize < 8) ? m_segmentSize : 8;
+	uint8_t n = (slots < max) ? slots : max;
+	memcpy(load, m_slotLoad, n);
+	return n;
+}
+
+// Read the code every digit shows right now.
+uint8_t Seg7Display::readFrame(uint8_t* out, uint8_t max)
+{
+	uint8_t n = (m_segmentSize < max) ? m_segmentSize : max;
+	for( uint8_t d=0; d<n; d++) {
+		out[d] = helperGlyph(d);
 	}
+	return n;
 }
 
 // Stop blinking one or more of the 7SEG digits.
 void Seg7Display::stopBlink()
 {
-	for(uint8_t i=0; i<8; i++) {
-		m_blink.nextToggle[i]	= 0;
-		m_blink.isOn[i]			= 1;
+	for(uint8_t g=0; g<SEG7_BLINK_SLOTS; g++) {
+		m_blink.members[g] = 0x00;
 	}
+	m_blink.isOn	= 0x00;
+	m_blink.visible	= (seg7Mask_t)~0;
 }
 
-// Stop scrolling display array.
+// Stop scrolling display array. Stops every region scrolling in row 0 and/or row 1.
 void Seg7Display::stopScroll( uint8_t displays) 
 {
-	if( displays & DISPLAY_LOWER ) {
-		m_scrollLower.delay = 0;
-	} 
-	if( displays & DISPLAY_UPPER ) {
-		m_scrollUpper.delay = 0;
+	for( uint8_t s=0; s<SEG7_MAX_SCROLLS; s++) {
+		uint8_t row = m_scroll[s].first / m_disp.cols;
+		if( (row==0 && (displays & DISPLAY_UPPER)) || (row==1 && (displays & DISPLAY_LOWER)) ) {
+			m_scroll[s].delay = 0;
+			m_scroll[s].source = NULL;
+		}
 	}
 }
 
@@ -249,71 +1019,550 @@ void Seg7Display::stopScroll( uint8_t displays)
 //
 //  =========================================================================
 
-// Helper method to decode ASCII tables.
+// Helper method to decode one character. All tables and rules are already resolved into m_font.
 uint8_t Seg7Display::asciiTo7seg(char ch)
 {
-	uint8_t start = *m_ascii_table;
-	uint8_t end   = *(m_ascii_table+1);
-	if( (ch>start) && (ch<=end))  {
-		return *(m_ascii_table + (ch-(start-2)));
+	SEG7_TRACE_SCOPE(SEG7_TRACE_DECODE);
+	uint8_t c = (uint8_t)ch;
+	return (c < SEG7_FONT_SIZE) ? m_font[c] : 0;
+}
+
+// Look a character up in the begin() table and the fallback tables, in that order.
+// An exact match in any table wins over the other case of a letter.
+uint8_t Seg7Display::helperFontLookup(uint8_t ch, uint8_t fold)
+{
+	uint8_t isLetter = ((ch|0x20)>='a' && (ch|0x20)<='z');
+	for( uint8_t pass=0; pass<2; pass++) {
+		for( uint8_t t=0; t<=SEG7_FONT_FALLBACKS; t++) {
+			const unsigned char *table = t ? m_fallback[t-1] : m_ascii_table;
+			if( !table ) {
+				continue;
+			}
+			uint8_t start = *table;
+			uint8_t end   = *(table+1);
+			if( (ch>=start) && (ch<=end) && table[ch-start+2] ) {
+				return table[ch-start+2];
+			}
+		}
+		if( !fold || !isLetter ) {
+			break;
+		}
+		ch ^= 0x20;			// Try the other case. Letters differ in bit 5 only.
 	}
-	if( ch>=0 && ch<32 ) { // Ok, get on of our special characters
+	if( ch<32 ) { // Ok, get on of our special characters
 		return SPECIAL_CHARS[ch];
 	}
 
-	return 0;  // The character was outside the ASCII table used.
+	return 0;  // The character was outside the ASCII tables used.
 }
 
-// Call this function to set up scrolling text for the upper or lower display.
-void Seg7Display::helperSetupScroll(String& str, scroll_t& scroll, char *disp, unsigned int t, uint8_t left)
+// Rebuild the font cache from the tables, rules and overrides, then re-encode the digits.
+void Seg7Display::helperFontResolve()
 {
-	for(uint8_t x=0; x<4; x++) {
-		*(disp+x) = ' ';
+	uint8_t fold = m_fontRules & SEG7_FONT_FOLD_CASE;
+	
+	for( uint8_t ch=0; ch<SEG7_FONT_SIZE; ch++) {
+		if( m_fontOverride[ch>>3] & (0x80 >> (ch&7)) ) {
+			continue;
+		}
+		uint8_t code = helperFontLookup(ch, fold);
+		if( !code && (m_fontRules & SEG7_FONT_LOOKALIKE) ) {
+			for( uint8_t x=0; LOOKALIKE_CHARS[x][0]; x++) {
+				if( LOOKALIKE_CHARS[x][0] == (char)ch ) {
+					code = helperFontLookup(LOOKALIKE_CHARS[x][1], fold);
+					break;
+				}
+			}
+		}
+		m_font[ch] = code;
+	}
+	
+	// Digits showing a character get its new code. Raw patterns ('\0') are left alone.
+	for( uint8_t i=0; i<SEG7_MAX_DIGITS; i++) {
+		if( m_disp.text[i] ) {
+			m_disp.code[i] = asciiTo7seg(m_disp.text[i]);
+		}
 	}
-	scroll.text = str;
-	scroll.delay = t;
-	scroll.time = millis();
-	scroll.toLeft = left;
-	scroll.marker = left?0:str.length()-1;
 }
 
-/// Helper function write text to any of the display buffers. 
-void Seg7Display::helperWrite(String& txt, char* buf, uint8_t len)
+// Find the scroll entry for a region, and blank the region for the new scroll.
+scroll_t* Seg7Display::helperSetupScroll(uint8_t row, uint8_t col, uint8_t width)
 {
-	uint8_t x;
-	if( txt.length()>len) {
-		txt.remove(len);
+	scroll_t* scroll = NULL;
+	if( !helperRegionMask(row, col, width, 1) ) {
+		return NULL;
 	}
-	for( x=0; x<txt.length(); x++) {
-		*(buf+x) = txt.charAt(x);
+	
+	// Restart the scroll of the same region, or take a free entry.
+	uint8_t first = row * m_disp.cols + col;
+	for( uint8_t s=0; s<SEG7_MAX_SCROLLS; s++) {
+		if( m_scroll[s].delay && m_scroll[s].first == first ) {
+			scroll = &m_scroll[s];
+			break;
+		}
+		if( !m_scroll[s].delay && !scroll ) {
+			scroll = &m_scroll[s];
+		}
+	}
+	if( !scroll ) {
+		return NULL;
+	}
+	
+	memset(m_disp.text + first, ' ', width);
+	memset(m_disp.code + first, 0x00, width);
+	m_coalesce.pending &= ~helperSpanMask(first, width);		// Older writes must not land on the scroll.
+	scroll->first = first;
+	scroll->len = width;
+	return scroll;
+}
+
+/// Helper function write text to a run of digits in the framebuffer. 
+void Seg7Display::helperWrite(const char* txt, unsigned int n, uint8_t first, uint8_t len)
+{
+	char *buf = m_disp.text + first;
+	uint8_t *code = m_disp.code + first;
+	uint8_t x = (n>len) ? len : n;
+	
+	// When coalescing, only record the latest text. refresh() applies it.
+	if( m_coalesce.minInterval ) {
+		seg7Mask_t mask = helperSpanMask(first, len);
+		if( m_coalesce.pending & mask ) {
+			m_coalesce.dropped++;
+		} else if( m_coalesce.pending || m_coalesce.dpsPending ) {
+			m_coalesce.merged++;
+		}
+		memcpy(m_coalesce.text + first, txt, x);
+		memset(m_coalesce.text + first + x, ' ', len - x);
+		m_coalesce.pending |= mask;
+		return;
 	}
-	while( x++ < len) {
+	
+	// Copy the text and encode it in one pass over the span.
+	memcpy(buf, txt, x);
+	encode(buf, x, code);
+	
+	// Pad the rest of the span with blanks.
+	for( ; x<len; x++) {
 		*(buf+x) = ' ';
+		*(code+x) = asciiTo7seg(' ');
+	}
+}
+
+// Print one character at the cursor, folding a '.' into the decimal point of the digit before.
+uint8_t Seg7Display::helperPrint(uint8_t ch)
+{
+	uint8_t size = m_disp.rows * m_disp.cols;
+	
+	switch( ch ) {
+		case '\r':
+			return 1;
+		
+		case '\n':
+			// Blank the rest of the row and go to the start of the next one.
+			// The cursor is already there if the last character filled the row.
+			if( m_cursorWrap ) {
+				m_cursorWrap = 0;
+			}
+			else if( m_cursor < size ) {
+				uint8_t end = (m_cursor / m_disp.cols + 1) * m_disp.cols;
+				for( ; m_cursor<end; m_cursor++) {
+					helperPrintDigit(m_cursor, ' ', 0);
+				}
+			}
+			if( m_cursor >= size ) {
+				m_cursor = 0;
+			}
+			m_cursorDot = 0;
+			return 1;
+		
+		case '.':
+			if( m_cursorDot ) {
+				helperPrintDigit(m_cursor-1, '\0', 1);
+				m_cursorDot = 0;
+				return 1;
+			}
+		break;
+		
+		case '\0':
+			ch = ' ';		// '\0' is not a character in the framebuffer.
+		break;
+	}
+	
+	if( m_cursor >= size ) {
+		return 0;
+	}
+	helperPrintDigit(m_cursor++, ch, 0);
+	m_cursorDot = 1;
+	m_cursorWrap = (m_cursor % m_disp.cols) == 0;
+	return 1;
+}
+
+// Set one digit and its decimal point for print().
+void Seg7Display::helperPrintDigit(uint8_t i, char ch, uint8_t dp)
+{
+	seg7Mask_t bit = SEG7_DIGIT_BIT(i);
+	
+	// When coalescing, record like helperWrite() and helperSetDps() do, but without counting
+	// every character of a print() as a dropped or merged update.
+	if( m_coalesce.minInterval ) {
+		if( !m_coalesce.dpsPending ) {
+			m_coalesce.dps = m_dps;
+			m_coalesce.dpsPending = 1;
+		}
+		if( ch ) {
+			m_coalesce.text[i] = ch;
+			m_coalesce.pending |= bit;
+		}
+		m_coalesce.dps = dp ? (m_coalesce.dps | bit) : (m_coalesce.dps & ~bit);
+		return;
+	}
+	
+	if( ch ) {
+		helperSetDigit(i, ch);
+	}
+	m_dps = dp ? (m_dps | bit) : (m_dps & ~bit);
+}
+
+// Clear and set decimal points, or record the result as pending when coalescing.
+void Seg7Display::helperSetDps(seg7Mask_t clear, seg7Mask_t set)
+{
+	if( m_coalesce.minInterval ) {
+		seg7Mask_t base = m_coalesce.dpsPending ? m_coalesce.dps : m_dps;
+		if( m_coalesce.dpsPending ) {
+			m_coalesce.dropped++;
+		} else if( m_coalesce.pending ) {
+			m_coalesce.merged++;
+		}
+		m_coalesce.dps = (base & ~clear) | set;
+		m_coalesce.dpsPending = 1;
+		return;
+	}
+	m_dps = (m_dps & ~clear) | set;
+}
+
+// Get the mask bits for a run of digits.
+seg7Mask_t Seg7Display::helperSpanMask(uint8_t first, uint8_t len)
+{
+	if( !len ) {
+		return 0;
+	}
+	seg7Mask_t mask = (seg7Mask_t)~0 << (SEG7_MASK_BITS - len);
+	return mask >> first;
+}
+
+// Get the digit mask of a rectangular region, 0 if it does not fit the framebuffer.
+seg7Mask_t Seg7Display::helperRegionMask(uint8_t row, uint8_t col, uint8_t width, uint8_t height)
+{
+	seg7Mask_t mask = 0;
+	if( !width || !height || (uint16_t)row + height > m_disp.rows || (uint16_t)col + width > m_disp.cols ) {
+		return 0;
+	}
+	for( uint8_t r=row; r<row+height; r++) {
+		mask |= helperSpanMask(r * m_disp.cols + col, width);
+	}
+	return mask;
+}
+
+// Get the digit span for DISPLAY_UPPER (row 0), DISPLAY_LOWER (row 1) or both.
+uint8_t Seg7Display::helperRow(uint8_t displays, uint8_t& first)
+{
+	uint8_t cols = m_disp.cols;
+	first = (displays & DISPLAY_UPPER) ? 0 : cols;
+	switch( displays & (DISPLAY_UPPER | DISPLAY_LOWER) ) {
+		case DISPLAY_UPPER:
+			return cols;
+		case DISPLAY_LOWER:
+			return (m_disp.rows > 1) ? cols : 0;
+		case DISPLAY_UPPER | DISPLAY_LOWER:
+			return (m_disp.rows > 1) ? 2*cols : cols;
+	}
+	return 0;
+}
+
+// Write a raw segment code to one digit, only touching it if the pattern changes or it showed a character.
+void Seg7Display::helperWriteCode(uint8_t i, uint8_t code)
+{
+	m_coalesce.pending &= ~SEG7_DIGIT_BIT(i);
+	if( m_disp.code[i] != code || m_disp.text[i] ) {
+		m_disp.code[i] = code;
+		m_disp.text[i] = '\0';		// No character for a raw pattern.
+	}
+}
+
+// Write one character to one digit, only touching it if it changes.
+void Seg7Display::helperSetDigit(uint8_t i, char ch)
+{
+	m_coalesce.pending &= ~SEG7_DIGIT_BIT(i);
+	if( m_disp.text[i] != ch ) {
+		m_disp.text[i] = ch;
+		m_disp.code[i] = asciiTo7seg(ch);
+	}
+}
+
+// Get the latest text of a digit, pending or shown.
+char Seg7Display::helperText(uint8_t i)
+{
+	return (m_coalesce.pending & SEG7_DIGIT_BIT(i)) ? m_coalesce.text[i] : m_disp.text[i];
+}
+
+// Write decimal points in place. Pending points get the same change so they cannot undo it.
+void Seg7Display::helperWriteDps(seg7Mask_t clear, seg7Mask_t set)
+{
+	m_dps = (m_dps & ~clear) | set;
+	m_coalesce.dps = (m_coalesce.dps & ~clear) | set;
+}
+
+// Set blink times for the digits in the mask.
+void Seg7Display::helperSetBlink(seg7Mask_t digit, unsigned int on, unsigned int off, unsigned long t)
+{
+	uint8_t g;
+	
+	on  = (on  > SEG7_MAX_BLINK_TIME) ? SEG7_MAX_BLINK_TIME : on;
+	off = (off > SEG7_MAX_BLINK_TIME) ? SEG7_MAX_BLINK_TIME : off;
+	
+	// The digits leave whatever group they were in.
+	for( g=0; g<SEG7_BLINK_SLOTS; g++) {
+		m_blink.members[g] &= ~digit;
+	}
+	
+	// Join a group with the same timing, keeping its phase ...
+	for( g=0; g<SEG7_BLINK_SLOTS; g++) {
+		if( m_blink.members[g] && m_blink.on[g]==on && m_blink.off[g]==off ) {
+			break;
+		}
+	}
+	
+	// ... else start a free group (or retime the last one) that toggles on at time t.
+	if( g == SEG7_BLINK_SLOTS ) {
+		g = 0;
+		while( g<SEG7_BLINK_SLOTS-1 && m_blink.members[g] ) {
+			g++;
+		}
+		m_blink.on[g]			= on;
+		m_blink.off[g]			= off;
+		m_blink.nextToggle[g]	= t;
+		m_blink.isOn		   &= ~(1<<g);
+	}
+	m_blink.members[g] |= digit;
+	
+	helperBlinkMask();
+}
+
+// Apply pending coalesced writes, touching only the pending digits.
+void Seg7Display::helperApplyPending()
+{
+	if( m_coalesce.pending ) {
+		for( uint8_t i=0; i<SEG7_MAX_DIGITS; i++) {
+			if( m_coalesce.pending & SEG7_DIGIT_BIT(i) ) {
+				helperSetDigit(i, m_coalesce.text[i]);
+			}
+		}
+		m_coalesce.pending = 0;
+	}
+	if( m_coalesce.dpsPending ) {
+		m_dps = m_coalesce.dps;
+		m_coalesce.dpsPending = 0;
+	}
+}
+
+// Restore the boot frame from EEPROM if the magic and checksum are valid.
+bool Seg7Display::restoreBootFrame()
+{
+#ifndef SEG7_NO_BOOT_FRAME
+	uint8_t buf[SEG7_BOOT_FRAME_SIZE];
+	uint8_t sum = 0;
+	uint8_t n;
+	
+	if( !bootEepromReady() ) {
+		return false;
+	}
+	// Read the fixed part first, it tells how many blink groups follow.
+	for( n=0; n<=BOOT_OFS_GROUPS; n++) {
+		buf[n] = EEPROM.read(SEG7_BOOT_FRAME_ADDR + n);
+	}
+	uint16_t area = (uint16_t)buf[BOOT_OFS_ROWS] * buf[BOOT_OFS_COLS];
+	if( buf[0]!=BOOT_MAGIC_0 || buf[1]!=BOOT_MAGIC_1 || buf[BOOT_OFS_SIZE]==0 || buf[BOOT_OFS_SIZE]>SEG7_MAX_DIGITS
+		|| area==0 || area>SEG7_MAX_DIGITS || buf[BOOT_OFS_GROUPS]>SEG7_BLINK_SLOTS ) {
+		return false;
+	}
+	uint8_t end = BOOT_OFS_GROUPS + 1 + buf[BOOT_OFS_GROUPS]*BOOT_GROUP_SIZE;
+	for( ; n<=end; n++) {
+		buf[n] = EEPROM.read(SEG7_BOOT_FRAME_ADDR + n);
+	}
+	for( n=0; n<end; n++) {
+		sum += buf[n];
+	}
+	if( (uint8_t)~sum != buf[end] ) {
+		return false;
+	}
+	
+	m_segmentSize = buf[BOOT_OFS_SIZE];
+	m_disp.rows = buf[BOOT_OFS_ROWS];
+	m_disp.cols = buf[BOOT_OFS_COLS];
+	memcpy(m_disp.code, buf + BOOT_OFS_CODE, SEG7_MAX_DIGITS);
+	memset(m_disp.text, '\0', SEG7_MAX_DIGITS);	// No text for a restored frame.
+	m_dps = bootGetMask(buf + BOOT_OFS_DPS);
+	m_coalesce.pending = 0;						// Writes from before begin() are older than the frame.
+	m_coalesce.dpsPending = 0;
+	
+	uint16_t now = m_clock();
+	n = BOOT_OFS_GROUPS + 1;
+	for( uint8_t g=0; g<buf[BOOT_OFS_GROUPS]; g++, n+=BOOT_GROUP_SIZE) {
+		const uint8_t* t = buf + n + sizeof(seg7Mask_t);
+		helperSetBlink(bootGetMask(buf + n), t[0] | (t[1]<<8), t[2] | (t[3]<<8), now);
+	}
+	return true;
+#else
+	return false;
+#endif // SEG7_NO_BOOT_FRAME
+}
+
+// Toggle the blink groups whose deadline has passed. O(groups).
+void Seg7Display::helperBlink(unsigned long now)
+{
+	SEG7_TRACE_SCOPE(SEG7_TRACE_BLINK);
+	uint8_t toggled = 0;
+	
+	// After a gap the 16 bit deadlines cannot measure, every group is late. Toggle and resync them all.
+	uint8_t late = (now - m_lastBlink) > SEG7_MAX_BLINK_TIME;
+	m_lastBlink = now;
+	
+	for( uint8_t g=0; g<SEG7_BLINK_SLOTS; g++) {
+		if( m_blink.members[g] && (late || (int16_t)((uint16_t)now - m_blink.nextToggle[g]) > 0) ) {
+			m_blink.isOn ^= 1<<g;
+			
+			// Advance from the old deadline to stay in phase, unless we are a whole period late.
+			uint16_t next = m_blink.nextToggle[g] + ((m_blink.isOn & (1<<g)) ? m_blink.on[g] : m_blink.off[g]);
+			if( late || (int16_t)((uint16_t)now - next) > 0 ) {
+				next = now + ((m_blink.isOn & (1<<g)) ? m_blink.on[g] : m_blink.off[g]);
+			}
+			m_blink.nextToggle[g] = next;
+			toggled = 1;
+		}
+	}
+	
+	if( toggled ) {
+		helperBlinkMask();
+	}
+}
+
+// Rebuild the visible digit mask from the groups that are off.
+void Seg7Display::helperBlinkMask()
+{
+	seg7Mask_t visible = (seg7Mask_t)~0;
+	for( uint8_t g=0; g<SEG7_BLINK_SLOTS; g++) {
+		if( !(m_blink.isOn & (1<<g)) ) {
+			visible &= ~m_blink.members[g];
+		}
 	}
+	m_blink.visible = visible;
+}
+
+// Apply one command from the command queue.
+void Seg7Display::applyCommand(const seg7Command_t& cmd)
+{
+	char buf[sizeof(cmd.text)+1];
+	uint8_t first;
+	uint8_t len;
+	
+	switch( cmd.op ) {
+		case SEG7_CMD_WRITE:
+			// Same path as writeUpper/writeLower, so coalescing and padding apply.
+			len = helperRow(cmd.arg, first);
+			helperWrite(cmd.text, sizeof(cmd.text), first, len);
+		break;
+		
+		case SEG7_CMD_WRITE_ONE:
+			if( cmd.arg && cmd.arg<=m_segmentSize ) {
+				helperSetDigit(cmd.arg-1, cmd.text[0]);
+			}
+		break;
+		
+		case SEG7_CMD_DECIMAL_POINTS:
+			setDecimalPoints(cmd.arg);
+		break;
+		
+		case SEG7_CMD_BLINK:
+			setBlink(cmd.arg, cmd.time1, cmd.time2);
+		break;
+		
+		case SEG7_CMD_STOP_BLINK:
+			stopBlink();
+		break;
+		
+		case SEG7_CMD_STOP_SCROLL:
+			stopScroll(cmd.arg);
+		break;
+		
+		case SEG7_CMD_BAR_GRAPH:
+			writeBarGraph(cmd.arg, cmd.time1, cmd.time2);
+		break;
+		
+		case SEG7_CMD_WRITE_REGION:
+			memcpy(buf, cmd.text, sizeof(cmd.text));
+			buf[sizeof(cmd.text)] = '\0';
+			writeRegion(cmd.row, cmd.col, cmd.width, cmd.height, buf);
+		break;
+		
+		case SEG7_CMD_SCROLL:
+			memcpy(buf, cmd.text, sizeof(cmd.text));
+			buf[sizeof(cmd.text)] = '\0';
+			if( cmd.arg & DISPLAY_UPPER ) {
+				scrollUpperEx(buf, cmd.time1, cmd.time2);
+			}
+			if( cmd.arg & DISPLAY_LOWER ) {
+				scrollLowerEx(buf, cmd.time1, cmd.time2);
+			}
+		break;
+	};
 }
 
 // Function that check what digits to display where when we are in scroll mode.
-void Seg7Display::helperScroll(scroll_t& scroll, char *disp)
+void Seg7Display::helperScroll(scroll_t& scroll)
 {
+	SEG7_TRACE_SCOPE(SEG7_TRACE_SCROLL);
 	uint8_t x;		// Helper loop variable.
+	uint8_t last = scroll.len - 1;
+	char *disp = m_disp.text + scroll.first;
+	uint8_t *code = m_disp.code + scroll.first;
 	
 	// This is a private method and we have already made sure that we are in scroll mode
 	//   for this array of 7 SEG digit display. 
 	// If scroll.delay != 0, then we are in scroll mode. So check this before calling this method.
-	if( (scroll.time + scroll.delay) < millis() ) {
+	if( (uint16_t)((uint16_t)m_clock() - scroll.time) > scroll.delay ) {
+		char ch;
+		if( scroll.source ) {
+			// Streaming mode: pull one character. If none is ready we keep the display as is.
+			int next = scroll.source(scroll.ctx);
+			if( next < 0 ) {
+				return;
+			}
+			ch = (char)next;
+		} else {
+			ch = scroll.text.charAt(scroll.marker);
+		}
+		
 		if( scroll.toLeft ) {
-			for(x=0; x<3; x++) {
+			for(x=0; x<last; x++) {
 				*(disp+x) = *(disp+x+1);
+				*(code+x) = *(code+x+1);
+			}
+			*(disp+x) = ch;
+			*(code+x) = asciiTo7seg(ch);
+			if( !scroll.source ) {
+				scroll.marker = (scroll.text.length()==(unsigned int)(scroll.marker+1))?0:scroll.marker+1;
 			}
-			*(disp+x) = scroll.text.charAt(scroll.marker);
-			scroll.marker = (scroll.text.length()==(scroll.marker+1))?0:scroll.marker+1;
 		} else {
-			for(x=3; x>0; x--) {
+			for(x=last; x>0; x--) {
 				*(disp+x) = *(disp+x-1);
+				*(code+x) = *(code+x-1);
+			}
+			*(disp+x) = ch;
+			*(code+x) = asciiTo7seg(ch);
+			if( !scroll.source ) {
+				scroll.marker = (scroll.marker==0)?scroll.text.length()-1:scroll.marker-1;
 			}
-			*(disp+x) = scroll.text.charAt(scroll.marker);
-			scroll.marker = (scroll.marker==0)?scroll.text.length()-1:scroll.marker-1;
 		}
-		scroll.time = millis();
+		scroll.time = m_clock();
 	}
 }
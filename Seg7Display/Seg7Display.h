@@ -155,71 +155,279 @@
  * 
  *  \def ERROR_CODE_OUT_OF_RANGE
  *  \brief return value from methods writeOneSegment and readOneSegment when reading/writing outside defined segments.
+ * 
+ *  \def ERROR_CODE_QUEUE_FULL
+ *  \brief return value from Seg7CommandQueue push methods when the command was dropped because the queue is full.
+ * 
+ *  \def ERROR_CODE_EEPROM_SIZE
+ *  \brief return value from saveBootFrame when the EEPROM the sketch started is too small for the boot frame.
  */
 #define ALL_OK								0
 #define ERROR_CODE_INVALID_SPI_MODE			1
 #define ERROR_CODE_INVALID_SS_PIN			2
 #define ERROR_CODE_TO_FEW_SEGMENTS			3
 #define ERROR_CODE_OUT_OF_RANGE				4
+#define ERROR_CODE_QUEUE_FULL				5
+#define ERROR_CODE_EEPROM_SIZE				6
  
 /*! \def DISPLAY_UPPER
- *  \brief defined number for upper display.
+ *  \brief defined number for upper display. This is row 0 of the framebuffer.
  * 
  *  \def DISPLAY_LOWER
- *  \brief defined number for lower display.
+ *  \brief defined number for lower display. This is row 1 of the framebuffer.
  */
 #define DISPLAY_UPPER						0X01
 #define DISPLAY_LOWER						0X02
 
+/*! \def SEG7_MAX_DIGITS
+ *  \brief Size of the framebuffer in digits (rows * columns). At most 32.
+ *
+ *  Digits are stored row-major. On the bus every 8 digits form one module: digit i is
+ *  scanned in slot i%8 of module i/8, and the modules are daisy-chained on one SS line.
+ *  The default fits the 2*4 digit shield.
+ *
+ *  \warning The default is 8, so setGeometry() fails with ERROR_CODE_OUT_OF_RANGE for any
+ *  panel bigger than 8 digits, e.g. setGeometry(3, 8). SEG7_MAX_DIGITS sizes the buffers
+ *  inside Seg7Display, so the library sources and the sketch must see the same value:
+ *  - PlatformIO: add -DSEG7_MAX_DIGITS=32 to build_flags.
+ *  - arduino-cli: pass --build-property "compiler.cpp.extra_flags=-DSEG7_MAX_DIGITS=32".
+ *  - Arduino IDE: change the default below in this file.
+ *  A \#define in the sketch before \#include <Seg7Display.h> is NOT enough: the library
+ *  is compiled on its own with the default, and the two disagree on the object layout.
+ *
+ *  \def SEG7_MAX_SCROLLS
+ *  \brief Number of regions that can scroll at the same time.
+ *
+ *  \def SEG7_MODULES
+ *  \brief Number of 8 digit modules needed for SEG7_MAX_DIGITS.
+ */
+#ifndef SEG7_MAX_DIGITS
+#define SEG7_MAX_DIGITS						8
+#endif
+#ifndef SEG7_MAX_SCROLLS
+#define SEG7_MAX_SCROLLS					2
+#endif
+#define SEG7_MODULES						((SEG7_MAX_DIGITS+7)/8)
+
+/**
+ * \typedef seg7Mask_t
+ *
+ * A bit per digit, for decimal points, blinking and pending writes. The first digit is the
+ * most significant bit, so with 8 digits 0x80 is the upper left digit as in setBlink().
+ */
+#if SEG7_MAX_DIGITS <= 8
+typedef uint8_t seg7Mask_t;
+#elif SEG7_MAX_DIGITS <= 16
+typedef uint16_t seg7Mask_t;
+#elif SEG7_MAX_DIGITS <= 32
+typedef uint32_t seg7Mask_t;
+#else
+#error "SEG7_MAX_DIGITS must be at most 32"
+#endif
+
+/*! \def SEG7_MASK_BITS
+ *  \brief Number of bits in seg7Mask_t.
+ *
+ *  \def SEG7_DIGIT_BIT
+ *  \brief The seg7Mask_t bit for digit i.
+ */
+#define SEG7_MASK_BITS						(8*sizeof(seg7Mask_t))
+#define SEG7_DIGIT_BIT(i)					((seg7Mask_t)((seg7Mask_t)1 << (SEG7_MASK_BITS-1-(i))))
+
+/*! \def SEG7_BOOT_FRAME_ADDR
+ *  \brief EEPROM address of the boot frame saved by saveBootFrame().
+ *
+ *  \def SEG7_BOOT_FRAME_SIZE
+ *  \brief Largest number of EEPROM bytes used by the boot frame.
+ *
+ *  \def SEG7_NO_BOOT_FRAME
+ *  \brief Define to build without the EEPROM boot frame (and without the EEPROM library).
+ */
+#ifndef SEG7_BOOT_FRAME_ADDR
+#define SEG7_BOOT_FRAME_ADDR				0
+#endif
+#define SEG7_BOOT_FRAME_SIZE				(7 + SEG7_MAX_DIGITS + sizeof(seg7Mask_t) + (4+sizeof(seg7Mask_t))*SEG7_BLINK_SLOTS)
+
+/// Lock-free queue for display commands from several tasks.
+#include "Seg7CommandQueue.h"
+
+/// Optional trace points (define SEG7_TRACE).
+#include "Seg7Trace.h"
+
+
+/*! \def SEG7_FONT_FALLBACKS
+ *  \brief Number of fallback tables that can be added with addFallbackTable().
+ *
+ *  \def SEG7_FONT_SIZE
+ *  \brief Number of characters in the resolved font cache. Characters from 128 and up are blank.
+ *
+ * Memory cost is SEG7_FONT_SIZE bytes for the cache plus one bit per character for the
+ * setGlyph() overrides, 144 bytes in all, and a pointer per fallback table, in every Seg7Display.
+ *
+ *  \def SEG7_FONT_FOLD_CASE
+ *  \brief setFontRules() flag: a missing letter is looked up in the other case.
+ *
+ *  \def SEG7_FONT_LOOKALIKE
+ *  \brief setFontRules() flag: a missing character is drawn as its look-alike from LOOKALIKE_CHARS.
+ */
+#ifndef SEG7_FONT_FALLBACKS
+#define SEG7_FONT_FALLBACKS					2
+#endif
+#define SEG7_FONT_SIZE						128
+#define SEG7_FONT_FOLD_CASE					0x01
+#define SEG7_FONT_LOOKALIKE					0x02
+
+/*! \def SEG7_BLINK_SLOTS
+ *  \brief Number of blink groups (different on/off timings) that can be in use at the same time. At most 8.
+ *
+ *  \def SEG7_MAX_BLINK_TIME
+ *  \brief Longest blink on or off time in milliseconds. Longer times are clamped.
+ */
+#ifndef SEG7_BLINK_SLOTS
+#define SEG7_BLINK_SLOTS					4
+#endif
+#define SEG7_MAX_BLINK_TIME					0x7FFF
+
+/*! \def SEG7_MAX_SCROLL_DELAY
+ *  \brief Longest scroll delay in milliseconds. Longer delays are clamped.
+ *
+ *  A step is due when more than the delay has passed since the last step, measured in 16 bits,
+ *  so refresh() must run at least once in every 65536 - SEG7_MAX_SCROLL_DELAY ms to see it.
+ */
+#define SEG7_MAX_SCROLL_DELAY				0x7FFF
 
 /**
  * \struct blinks
  *
- * A display structure containing blink information for two 4 digit 7 SEG displays. 
+ * A display structure containing blink information for all digits in the framebuffer. 
+ *
+ * Digits that blink with the same on/off times form a group with one timer. refresh() only
+ * checks the group timers and, when a group toggles, rebuilds the visible digit mask from the
+ * group member masks, so the cost per refresh is O(groups) and not O(digits). Deadlines are
+ * advanced from the previous deadline, so groups stay phase-locked to each other and do not
+ * drift with refresh() jitter.
+ *
+ * Timing is kept as 16 bit millisecond deadlines relative to the low 16 bits of millis(),
+ * compared with wraparound-safe signed differences.
+ * Memory cost is 6 bytes plus one seg7Mask_t per group, plus one seg7Mask_t and a byte,
+ * with no per digit cost besides one member bit.
  */
 typedef struct blinks {
-	unsigned long	on[8];			/*!< Containing time in milliseconds that blink is on. */
-	unsigned long	off[8];			/*!< Containing time in milliseconds that blink is off. */
-	unsigned long	nextToggle[8];	/*!< Containing time in milliseconds for next toggle. */
-	uint8_t			isOn[8];		/*!< True if the digit is on. */
-	void*			next;			/*!< Pointer to next 7SEG array. Not implemented yet. */
-}blink_t;							/*!< typedef for structure blinks */
+	uint16_t		on[SEG7_BLINK_SLOTS];			/*!< Time in milliseconds that the group is on. */
+	uint16_t		off[SEG7_BLINK_SLOTS];			/*!< Time in milliseconds that the group is off. */
+	uint16_t		nextToggle[SEG7_BLINK_SLOTS];	/*!< Low 16 bits of millis() for the next toggle of the group. */
+	seg7Mask_t		members[SEG7_BLINK_SLOTS];		/*!< Digits in the group. 0 if the group is free. */
+	seg7Mask_t		visible;						/*!< Digits that are lit, i.e. not in a group that is off. */
+	uint8_t			isOn;							/*!< Bit per group, set if the group is on. */
+}blink_t;											/*!< typedef for structure blinks */
+
+static_assert(SEG7_BLINK_SLOTS <= 8, "blink_t::isOn has one bit per group");
+static_assert(sizeof(blink_t) <= (6+sizeof(seg7Mask_t))*SEG7_BLINK_SLOTS + 2*sizeof(seg7Mask_t), "blink_t must stay packed");
 
 /**
  * \struct displays
  *
- * A display type containing text arrays for two 4 digit 7 SEG displays.
- * This is a union of upLo[8] and two 4 char arrays (upper and lower).
+ * A rows * cols framebuffer of 7 SEG digits.
  *
- * disp_t also contains a next pointer to support an array of 2*4 digit displays.
+ * Both arrays are row-major and contiguous, so digit (row, col) is at index row*cols + col
+ * and a whole row, or a run of whole rows, is one linear copy. The 2*4 digit shield is
+ * 2 rows of 4: the upper display is row 0 and the lower display is row 1.
  *
  */
 typedef struct displays {
-	union {
-		char	upLo[8];				/*!< The eight digits for the upper and lower displays. */
-		struct {
-			char	upper[4];			/*!< The four digits for the upper display. */
-			char 	lower[4];			/*!< The four digits for the lower display. */
-		};
-	};
-	void*	next;						/*!< Pointer to the next 2*4 display. Not implemented yet. */
+	char		text[SEG7_MAX_DIGITS];	/*!< The character shown on each digit, '\0' for raw segment patterns. */
+	uint8_t		code[SEG7_MAX_DIGITS];	/*!< The 7SEG code for each digit. Kept in sync with text so refresh() does not decode. */
+	uint8_t		rows;					/*!< Number of rows in use. */
+	uint8_t		cols;					/*!< Number of digits per row. */
 }disp_t;								/*!< typedef for structure displays */
 
+static_assert(sizeof(disp_t) == 2*SEG7_MAX_DIGITS + 2, "disp_t must be two bytes per digit");
+
+/**
+ * \typedef scrollSource_t
+ *
+ * Callback used by streaming scroll to pull the next character to shift in.
+ * It is called once per scroll step with the context pointer given to scrollUpperStream()
+ * or scrollLowerStream() and must return the next character (0..255), or a negative value
+ * when no character is available yet. The scroll then pauses until data arrives.
+ */
+typedef int (*scrollSource_t)(void* ctx);
+
+/**
+ * \struct scrollRing
+ *
+ * A small single-producer/single-consumer ring buffer that can feed a streaming scroll.
+ * The caller owns the storage (buf/size), so memory use is bounded by size regardless of
+ * how long the scrolled message is. Fill it with Seg7Display::ringPush() and pass it to
+ * scrollUpperRing() or scrollLowerRing().
+ */
+typedef struct scrollRing {
+	char*				buf;		/*!< Caller supplied storage. */
+	uint8_t				size;		/*!< Size of buf in bytes. One byte is kept free to tell full from empty. */
+	volatile uint8_t	head;		/*!< Next position to write. Only changed by the producer. */
+	volatile uint8_t	tail;		/*!< Next position to read. Only changed by the scroll (consumer). */
+}scrollRing_t;						/*!< typedef for structure scrollRing */
+
 /**
  * \struct scroll
  *
- * A scroll type containing time information for scrolling one 4 digit display left or right.
- * text in scroll_t is a String object containing the text to be scrolled for that display.
+ * A scroll type containing time information for scrolling one region (a run of digits in
+ * one row) left or right. text in scroll_t is a String object containing the text to be scrolled for that display.
+ * When source is set the text is not used and characters are pulled from source instead,
+ * and text holds no heap memory.
  *
+ * Times are 16 bits relative to the low 16 bits of millis(), so the delay is at most SEG7_MAX_SCROLL_DELAY.
  */
 typedef struct scroll {
-	unsigned long		time;		/*!< The time (milliseconds) when the scroll text was updated last time. */
+	scrollSource_t		source;		/*!< Streaming source, or NULL when scrolling text. */
+	void*				ctx;		/*!< Context pointer passed to source. */
 	String				text;		/*!< The text to scroll. */
-	unsigned long		delay;		/*!< The scroll delay time in milliseconds. */
-	uint8_t				toLeft;		/*!< True if the text scrolls from right to left. */
+	uint16_t			time;		/*!< Low 16 bits of millis() when the scroll text was updated last time. */
+	uint16_t			delay;		/*!< The scroll delay time in milliseconds. 0 when not scrolling. */
 	uint8_t				marker;		/*!< Marks which digit we are printing on the current 7SEG display segment. */
+	uint8_t				toLeft;		/*!< True if the text scrolls from right to left. */
+	uint8_t				first;		/*!< Index of the first digit of the region. */
+	uint8_t				len;		/*!< Number of digits in the region. */
 }scroll_t;							/*!< typedef for structure scroll */
+
+static_assert(sizeof(scroll_t) <= 2*sizeof(void*) + sizeof(String) + 10, "scroll_t must stay packed");
 		
+/**
+ * \typedef seg7Clock_t
+ *
+ * Time source returning milliseconds, like millis(). All scroll, blink and coalescing timing
+ * reads the time through this, so a test harness can drive the library with a virtual clock.
+ */
+typedef unsigned long (*seg7Clock_t)();
+
+/**
+ * \typedef seg7Bus_t
+ *
+ * Bus output hook. Called once per SS frame with the 16 bit words that would go out over SPI,
+ * in bus order. A host program can record the frames through this, e.g. to check that an
+ * optimized scan path produces the same frames as a recorded golden run.
+ */
+typedef void (*seg7Bus_t)(void* ctx, const uint16_t* words, uint8_t count);
+
+/**
+ * \struct coalesce
+ *
+ * Pending writes and statistics for latest-wins update coalescing.
+ * Writes made while an update is pending are merged into it, and only the latest text for
+ * each digit is applied at the next frame boundary allowed by minInterval.
+ */
+typedef struct coalesce {
+	uint16_t			minInterval;	/*!< Shortest time in milliseconds between applied updates. 0 when coalescing is off. */
+	uint16_t			lastApply;		/*!< Low 16 bits of millis() when pending writes were applied last time. */
+	uint16_t			merged;			/*!< Writes that joined an update that was already pending. */
+	uint16_t			dropped;		/*!< Writes that replaced pending digits before they were ever shown. */
+	uint16_t			applied;		/*!< Number of coalesced updates applied to the display. */
+	char				text[SEG7_MAX_DIGITS];	/*!< Latest pending text per digit. */
+	seg7Mask_t			pending;		/*!< Digits with pending text. */
+	seg7Mask_t			dps;			/*!< Latest pending decimal points. */
+	uint8_t				dpsPending;		/*!< True if dps is pending. */
+}coalesce_t;							/*!< typedef for structure coalesce */
+
 /**
  * \class Seg7Display
  *
@@ -229,6 +437,12 @@ typedef struct scroll {
  * This library has been tested with the SPI 7-SEG 4DIGIT DISPLAY ARDUINO SHIELD.
  * This is a open source hardware project that exists in CircuitMaker.
  *
+ * Seg7Display is also an Arduino Print, so print() and println() write straight into
+ * the framebuffer at a cursor:
+ *
+ *		seg.setCursor(1, 0);
+ *		seg.print(23.75, 1);		// "23.8" on the lower display, the '.' as a decimal point.
+ *
  * \version 1.0 $
  *
  * \date 2015/10/07 $
@@ -236,7 +450,7 @@ typedef struct scroll {
  * Created on:  2015/10/07
  *
  */
-class Seg7Display
+class Seg7Display : public Print
 {
 	public:	
 		//! Seg7Display default constructor.
@@ -247,10 +461,58 @@ class Seg7Display
 		  \param [in] pin the SS (SlaveSelect) pin number.
 		  \param [in] table pointer to a ASCII 2 7SEG decode table.
 		  \return Returns ALL_OK on success. 
+		  \note If a boot frame was saved with saveBootFrame(), the first begin() call restores and
+		  shows it right after the SPI is set up, before anything else is done. Calling begin()
+		  again to switch tables keeps what is on the display.
 		  \sa ascii-tables.h for availabe decode tables.
 		  \sa ALL_OK for error codes.
+		  \sa addFallbackTable(), setFontRules() and setGlyph() to fill in characters the table lacks.
 	    */
 		uint8_t		begin(uint8_t pin, const unsigned char *table);
+
+		//! Adds a table that is searched for characters the begin() table does not have.
+		/*!
+		  Fallback tables are searched in the order they were added. All font settings are
+		  resolved into one lookup cache when they change, so rendering costs one load per
+		  character however many tables and rules there are.
+		  \param [in] table pointer to a ASCII 2 7SEG decode table.
+		  \return Returns ALL_OK on success, ERROR_CODE_OUT_OF_RANGE if SEG7_FONT_FALLBACKS tables are already added.
+	    */
+		uint8_t		addFallbackTable(const unsigned char *table);
+
+		//! Sets the substitution rules for characters that no table has.
+		/*!
+		  \param [in] rules is SEG7_FONT_FOLD_CASE and/or SEG7_FONT_LOOKALIKE, or 0 for none (default).
+	    */
+		void		setFontRules(uint8_t rules);
+
+		//! Overrides the 7SEG code of one character.
+		/*!
+		  An override wins over all tables and rules.
+		  \param [in] ch is the character, 0..127.
+		  \param [in] code is the 7SEG code to draw for ch.
+		  \return Returns ALL_OK on success, ERROR_CODE_OUT_OF_RANGE if ch is outside the font.
+	    */
+		uint8_t		setGlyph(char ch, uint8_t code);
+
+		//! Removes all fallback tables, rules and overrides. The begin() table is kept.
+		void		resetFont();
+
+		//! Saves the current frame as the boot frame that begin() shows at power-up.
+		/*!
+		  Saves the encoded digits, the number of digits, the decimal points and the blink groups
+		  in at most SEG7_BOOT_FRAME_SIZE bytes of EEPROM at SEG7_BOOT_FRAME_ADDR. Unchanged bytes
+		  are not rewritten. Scrolling is not saved.
+		  \note On ESP8266 and ESP32 the library only calls EEPROM.begin() when the sketch has not
+		  started EEPROM yet, so a buffer the sketch started, and its uncommitted writes, are kept.
+		  A sketch that uses EEPROM itself must start it with at least
+		  SEG7_BOOT_FRAME_ADDR + SEG7_BOOT_FRAME_SIZE bytes.
+		  \return Returns ALL_OK on success, ERROR_CODE_EEPROM_SIZE if the EEPROM is too small.
+	    */
+		uint8_t		saveBootFrame();
+
+		//! Removes the boot frame so begin() starts with a blank display again.
+		void		clearBootFrame();
 		
 		//! Sets the number of display segments available.
 		/*!
@@ -260,21 +522,52 @@ class Seg7Display
 	    */
 		uint8_t 	setSegmentsArraySize(uint8_t size);
 		
+		//! Sets the framebuffer size and the number of digits to the whole framebuffer.
+		/*!
+		  The default is 2 rows of 4 digits, the 2*4 digit shield. rows*cols must fit
+		  SEG7_MAX_DIGITS, which is 8 unless it is raised for the whole build, see there.
+		  \param [in] rows is the number of rows.
+		  \param [in] cols is the number of digits per row.
+		  \return Returns ALL_OK on success, ERROR_CODE_OUT_OF_RANGE if rows*cols is 0 or above SEG7_MAX_DIGITS.
+	    */
+		uint8_t 	setGeometry(uint8_t rows, uint8_t cols);
+
+		//! writes text to a rectangular region of the framebuffer.
+		/*!
+		  The region is filled row by row from txt. If txt ends early the rest is blank.
+		  A region of whole rows is written with one linear copy.
+		  \param [in] row is the top row of the region.
+		  \param [in] col is the left column of the region.
+		  \param [in] width is the number of digits per row in the region.
+		  \param [in] height is the number of rows in the region.
+		  \param [in] txt is the text, row-major, width*height characters.
+		  \return Returns ALL_OK on success, ERROR_CODE_OUT_OF_RANGE if the region is outside the framebuffer.
+	    */
+		uint8_t 	writeRegion(uint8_t row, uint8_t col, uint8_t width, uint8_t height, const char* txt);
+
+		//! writes text to one whole row.
+		/*!
+		  \param [in] row is the row to write.
+		  \param [in] txt is the text to display.
+		  \return Returns ALL_OK on success, ERROR_CODE_OUT_OF_RANGE if the row does not exist.
+	    */
+		uint8_t 	writeRow(uint8_t row, const char* txt);
+
 		//! writes a String to the display.
 		/*!
-		  \param [in] txt is the String object to be displayed
+		  \param [in] txt is the String object to be displayed. It fills the whole framebuffer.
 	    */
 		void	 	writeSegments(String txt);
 
 		//! writes a String to the display.
 		/*!
-		  \param [in] txt is the String object to be displayed
+		  \param [in] txt is the String object to be displayed on row 0.
 	    */
 		void 		writeUpper(String txt);
 
 		//! writes a String to the display.
 		/*!
-		  \param [in] txt is the String object to be displayed
+		  \param [in] txt is the String object to be displayed on row 1.
 	    */
 		void 		writeLower(String txt);
 		
@@ -330,10 +623,104 @@ class Seg7Display
 	    */
 		void 		scrollUpper(unsigned int t, uint8_t left);
 
+		//! scrolls characters pulled from a callback on the upper display.
+		/*!
+		  \param [in] src is called once per scroll step to get the next character.
+		  \param [in] ctx is passed unchanged to src.
+		  \param [in] t is the scroll delay time in milliseconds.
+		  \param [in] left is true (not 0) for left scroll. Otherwise we scroll to the right.
+		  \sa scrollSource_t
+	    */
+		void		scrollUpperStream(scrollSource_t src, void* ctx, unsigned int t, uint8_t left);
+
+		//! scrolls characters pulled from a callback on the lower display.
+		/*!
+		  \param [in] src is called once per scroll step to get the next character.
+		  \param [in] ctx is passed unchanged to src.
+		  \param [in] t is the scroll delay time in milliseconds.
+		  \param [in] left is true (not 0) for left scroll. Otherwise we scroll to the right.
+		  \sa scrollSource_t
+	    */
+		void		scrollLowerStream(scrollSource_t src, void* ctx, unsigned int t, uint8_t left);
+
+		//! scrolls characters from a ring buffer on the upper display.
+		/*!
+		  \param [in] ring is the ring buffer to read from. It must outlive the scroll.
+		  \param [in] t is the scroll delay time in milliseconds.
+		  \param [in] left is true (not 0) for left scroll. Otherwise we scroll to the right.
+	    */
+		void		scrollUpperRing(scrollRing_t& ring, unsigned int t, uint8_t left);
+
+		//! scrolls characters from a ring buffer on the lower display.
+		/*!
+		  \param [in] ring is the ring buffer to read from. It must outlive the scroll.
+		  \param [in] t is the scroll delay time in milliseconds.
+		  \param [in] left is true (not 0) for left scroll. Otherwise we scroll to the right.
+	    */
+		void		scrollLowerRing(scrollRing_t& ring, unsigned int t, uint8_t left);
+
+		//! scrolls a text in a region of one row.
+		/*!
+		  \param [in] row is the row of the region.
+		  \param [in] col is the left column of the region.
+		  \param [in] width is the number of digits in the region.
+		  \param [in] str is the text to be scrolled.
+		  \param [in] t is the scroll delay time in milliseconds. Longer delays are clamped to SEG7_MAX_SCROLL_DELAY.
+		  \param [in] left is true (not 0) for left scroll. Otherwise we scroll to the right.
+		  \return Returns ALL_OK on success, ERROR_CODE_OUT_OF_RANGE if the region is outside the
+		  framebuffer or SEG7_MAX_SCROLLS regions are already scrolling.
+	    */
+		uint8_t		scrollRegionEx(uint8_t row, uint8_t col, uint8_t width, String str, unsigned int t, uint8_t left);
+
+		//! scrolls characters pulled from a callback in a region of one row.
+		/*!
+		  \param [in] row is the row of the region.
+		  \param [in] col is the left column of the region.
+		  \param [in] width is the number of digits in the region.
+		  \param [in] src is called once per scroll step to get the next character.
+		  \param [in] ctx is passed unchanged to src.
+		  \param [in] t is the scroll delay time in milliseconds. Longer delays are clamped to SEG7_MAX_SCROLL_DELAY.
+		  \param [in] left is true (not 0) for left scroll. Otherwise we scroll to the right.
+		  \return Returns ALL_OK on success, ERROR_CODE_OUT_OF_RANGE if the region is outside the
+		  framebuffer or SEG7_MAX_SCROLLS regions are already scrolling.
+	    */
+		uint8_t		scrollRegionStream(uint8_t row, uint8_t col, uint8_t width, scrollSource_t src, void* ctx, unsigned int t, uint8_t left);
+
+		//! Stops the scroll of the region starting at row and col.
+		/*!
+		  \param [in] row is the row of the region.
+		  \param [in] col is the left column of the region.
+	    */
+		void		stopScrollRegion(uint8_t row, uint8_t col);
+
+		//! Sets up an empty ring buffer on caller supplied storage.
+		/*!
+		  \param [out] ring is the ring buffer to initialize.
+		  \param [in] buf is the storage to use.
+		  \param [in] size is the size of buf. The ring holds at most size-1 characters.
+	    */
+		static void	ringInit(scrollRing_t& ring, char* buf, uint8_t size);
+
+		//! Adds one character to a ring buffer.
+		/*!
+		  \param [in] ring is the ring buffer to add to.
+		  \param [in] ch is the character to add.
+		  \return Returns ALL_OK on success, ERROR_CODE_OUT_OF_RANGE if the ring is full.
+	    */
+		static uint8_t	ringPush(scrollRing_t& ring, char ch);
+
+		//! Removes one character from a ring buffer. Can be used as a scrollSource_t.
+		/*!
+		  \param [in] ring is a pointer to a scrollRing_t.
+		  \return Returns the character, or -1 if the ring is empty.
+	    */
+		static int	ringPull(void* ring);
+
 		//! Function to set one or more decimal points.
 		/*!
 		 * Upper display: First (leftmost) digit == 0x80, second == 0x40, third == 0x20, fourth (last) == 0x10.
 		 * Lower display: First (leftmost) digit == 0x08, second == 0x04, third == 0x02, fourth (last) == 0x01.
+		 * The mask covers the first 8 digits of the framebuffer, use setDecimalPoint() for the others.
 	    */
 		void		setDecimalPoints(uint8_t points);
 		
@@ -344,11 +731,197 @@ class Seg7Display
 		  \param [in] off is time in milliseconds that the digits are off.
 		 
 		  \note
+		  on and off are clamped to SEG7_MAX_BLINK_TIME. Digits given the same on/off times
+		  as a group that is already blinking join that group and blink in phase with it.
+		  Up to SEG7_BLINK_SLOTS groups can be in use at once; if a new timing does not fit,
+		  the last group is retimed and the digits in it change timing too.
 		  Upper display: First (leftmost) digit == 0x80, second == 0x40, third == 0x20, fourth (last) == 0x10.
 		  Lower display: First (leftmost) digit == 0x08, second == 0x04, third == 0x02, fourth (last) == 0x01.
+		  The mask covers the first 8 digits of the framebuffer, use setBlinkRegion() for the others.
 	    */
 		void		setBlink(uint8_t digit, unsigned int on, unsigned int off);
+
+		//! Blinks a rectangular region of the framebuffer.
+		/*!
+		  Same as setBlink(), for the digits in the region.
+		  \param [in] row is the top row of the region.
+		  \param [in] col is the left column of the region.
+		  \param [in] width is the number of digits per row in the region.
+		  \param [in] height is the number of rows in the region.
+		  \param [in] on is time in milliseconds that the digits is on.
+		  \param [in] off is time in milliseconds that the digits are off.
+		  \return Returns ALL_OK on success, ERROR_CODE_OUT_OF_RANGE if the region is outside the framebuffer.
+	    */
+		uint8_t		setBlinkRegion(uint8_t row, uint8_t col, uint8_t width, uint8_t height, unsigned int on, unsigned int off);
+
+		//! Sets or clears the decimal point of one digit.
+		/*!
+		  \param [in] row is the row of the digit.
+		  \param [in] col is the column of the digit.
+		  \param [in] on is true (not 0) to light the decimal point.
+		  \return Returns ALL_OK on success, ERROR_CODE_OUT_OF_RANGE if the digit is outside the framebuffer.
+	    */
+		uint8_t		setDecimalPoint(uint8_t row, uint8_t col, uint8_t on);
 		
+		//! Encodes a span of characters to 7SEG codes in one pass.
+		/*!
+		  Uses the resolved font (the begin() table, fallbacks, rules and overrides), with one
+		  cache load per character and no per-call setup. Characters from 128 up give 0.
+		  The write functions use this internally, but it can also be used to render into
+		  an application owned buffer.
+		  \param [in] txt is the text to encode. It does not need to be zero terminated.
+		  \param [in] len is the number of characters in txt.
+		  \param [out] out receives len 7SEG codes (decimal point not included).
+	    */
+		void		encode(const char* txt, unsigned int len, uint8_t* out);
+
+		//! Shows a horizontal bar graph on one or both displays.
+		/*!
+		  Every digit has two steps: left bar (SYM_BAR_L) and left + right bar. The segment
+		  codes are written straight into the encoded buffer and only digits whose pattern
+		  changes are touched, so this can be called at a high rate.
+		  \param [in] displays can be DISPLAY_UPPER, DISPLAY_LOWER or both (then the bar runs over all 8 digits).
+		  \param [in] value is the level to show, 0..max.
+		  \param [in] max is the full scale value. Values above max are shown as full.
+		  \note readOneSegment() returns '\0' for digits written by this function.
+	    */
+		void		writeBarGraph(uint8_t displays, uint16_t value, uint16_t max);
+
+		//! Shows one vertical level per digit (VU-meter style) on one or both displays.
+		/*!
+		  Every digit shows 0..3 horizontal segments: D, D+G or D+G+A.
+		  Only digits whose pattern changes are touched.
+		  \param [in] displays can be DISPLAY_UPPER, DISPLAY_LOWER or both.
+		  \param [in] values holds one value per digit (4, or 8 for both displays), 0..max.
+		  \param [in] max is the full scale value. Values above max are shown as full.
+		  \note readOneSegment() returns '\0' for digits written by this function.
+	    */
+		void		writeLevels(uint8_t displays, const uint16_t* values, uint16_t max);
+
+		//! Writes a decimal counter value to one or both displays.
+		/*!
+		  The digits themselves hold the counter state, so countUp() and countDown() only
+		  touch the digits affected by the carry or borrow.
+		  \param [in] displays can be DISPLAY_UPPER, DISPLAY_LOWER or both.
+		  \param [in] value is the start value. Only the lowest digits that fit are shown.
+		  \param [in] zeroPad is true (not 0) to show leading zeros. Otherwise they are blank.
+		  \return Returns ALL_OK on success, ERROR_CODE_OUT_OF_RANGE if no display was selected.
+	    */
+		uint8_t		writeCounter(uint8_t displays, unsigned long value, uint8_t zeroPad);
+
+		//! Adds one to a counter set up with writeCounter(). Wraps to zero on overflow.
+		/*!
+		  \param [in] displays is the same selection as given to writeCounter().
+	    */
+		void		countUp(uint8_t displays);
+
+		//! Subtracts one from a counter set up with writeCounter(). Wraps to all nines below zero.
+		/*!
+		  \param [in] displays is the same selection as given to writeCounter().
+	    */
+		void		countDown(uint8_t displays);
+
+		//! Writes a clock to one or both displays, using decimal points as separators.
+		/*!
+		  With both displays (8 digits, or any span of at least 6) the clock is shown right aligned as HH.MM.SS and wraps after 23.59.59.
+		  With one display (4 digits) it is shown as MM.SS and wraps after 59.59.
+		  \param [in] displays can be DISPLAY_UPPER, DISPLAY_LOWER or both.
+		  \param [in] hours is 0..23. Not shown on a 4 digit display.
+		  \param [in] minutes is 0..59.
+		  \param [in] seconds is 0..59.
+		  \return Returns ALL_OK on success, ERROR_CODE_OUT_OF_RANGE on an invalid time or display.
+	    */
+		uint8_t		writeClock(uint8_t displays, uint8_t hours, uint8_t minutes, uint8_t seconds);
+
+		//! Advances a clock set up with writeClock() by one second.
+		/*!
+		  \param [in] displays is the same selection as given to writeClock().
+	    */
+		void		clockTick(uint8_t displays);
+
+		//! Moves a clock set up with writeClock() back by one second, for count down timers.
+		/*!
+		  \param [in] displays is the same selection as given to writeClock().
+	    */
+		void		clockTickDown(uint8_t displays);
+
+		//! Limits how often writes reach the display, coalescing the writes in between.
+		/*!
+		  When on, writeSegments(), writeUpper(), writeLower() and setDecimalPoints() only record the
+		  latest value per digit. refresh() applies what is pending at most once per minInterval,
+		  so high-rate producers only pay for copying into the pending buffer.
+		  The writers that update digits in place (writeOneSegment(), the counter, clock, bar graph
+		  and level writers, and the start of a scroll) still show at the next refresh(), and cancel
+		  what is pending for the digits and decimal points they write, so the latest write wins.
+		  \param [in] minInterval is the shortest time in milliseconds between applied updates.
+		  0 turns coalescing off and applies anything pending right away.
+	    */
+		void		setMaxUpdateRate(uint16_t minInterval);
+
+		//! Coalescing statistics: merged, dropped and applied update counters.
+		/*!
+		  \return Returns the coalescing state. The counters wrap at 65535.
+		  \sa setMaxUpdateRate
+	    */
+		const coalesce_t&	coalesceStats() const { return m_coalesce; }
+
+		//! Sets the time source used for all timing in the library.
+		/*!
+		  The library never blocks on time, so with a virtual clock whole scroll and blink
+		  schedules can be stepped through as fast as refresh() can be called.
+		  \param [in] clock returns the time in milliseconds. NULL selects millis(), the default.
+	    */
+		void		setClock(seg7Clock_t clock);
+
+		//! Attaches a command queue that refresh() drains before it updates the display.
+		/*!
+		  When several tasks write to the display they should all go through the queue,
+		  and only the task calling refresh() should use the other functions directly.
+		  \param [in] queue is the queue to drain, or NULL to detach.
+	    */
+		void		attachQueue(Seg7CommandQueue* queue);
+
+		//! Sends the frames of refresh() to a hook instead of the SPI bus.
+		/*!
+		  \param [in] bus is called once per SS frame, or NULL to use the SPI bus again (default).
+		  \param [in] ctx is passed unchanged to bus.
+	    */
+		void		setBus(seg7Bus_t bus, void* ctx);
+
+		//! Reads what the digits show right now.
+		/*!
+		  Gives one 7SEG code per digit, with the decimal point, and 0 for a digit that is
+		  blinked off. This is what refresh() puts on the glass, independent of how the scan
+		  is done, so two runs can be compared digit by digit.
+		  \param [out] out receives up to max codes.
+		  \param [in] max is the size of out.
+		  \return Returns the number of codes written, the number of digits or max.
+	    */
+		uint8_t		readFrame(uint8_t* out, uint8_t max);
+
+		//! Caps the number of segments lit at the same time.
+		/*!
+		  All modules light the digit of the same scan slot at once, so a slot showing "8." on
+		  every module draws the most current. With a budget, refresh() splits every slot into
+		  the same number of sub-frames, enough that no sub-frame lights more than maxLit
+		  segments. The lit segments of a slot are dealt round-robin over its sub-frames, so
+		  each segment is on in exactly one sub-frame and all segments get the same on-time.
+		  refresh() sends more frames, so call it more often to keep the scan rate.
+		  \param [in] maxLit is the most segments (decimal points included) lit at once, or 0 for no limit (default).
+	    */
+		void		setSegmentBudget(uint8_t maxLit);
+
+		//! Reports the segment load of the last refresh().
+		/*!
+		  \param [out] load receives, per scan slot, the most segments lit at once in that slot.
+		  \param [in] max is the size of load.
+		  \return Returns the number of slots reported.
+	    */
+		uint8_t		readSegmentLoad(uint8_t* load, uint8_t max);
+
+		//! Number of sub-frames per scan slot in the last refresh(). 1 without a budget.
+		uint8_t		subFrames() const { return m_subFrames; }
+
 		//! Stop blinking all digits.
 		/*!
 		 * 
@@ -361,6 +934,41 @@ class Seg7Display
 	    */
 		void stopScroll( uint8_t displays);
 
+		//! Writes one character at the cursor and moves the cursor. Used by print().
+		/*!
+		  The cursor moves row by row through the framebuffer. A '.' after a character lights
+		  the decimal point of that digit instead of taking a digit of its own. '\n' blanks the
+		  rest of the row and moves to the start of the next row (row 0 after the last one).
+		  A '\n' right after a character that filled the last column does not move again, so
+		  println() of a text as wide as a row does not skip a row.
+		  '\r' is ignored, so println() ends the row the same way.
+		  \param [in] ch is the character.
+		  \return Returns 1, or 0 if the cursor is past the last digit.
+	    */
+		virtual size_t	write(uint8_t ch);
+
+		//! Writes characters at the cursor, encoding them directly into the framebuffer.
+		/*!
+		  Same as write(uint8_t) for each character, without building a String first.
+		  \param [in] buf is the characters.
+		  \param [in] size is the number of characters.
+		  \return Returns the number of characters used. Stops when the framebuffer is full.
+	    */
+		virtual size_t	write(const uint8_t *buf, size_t size);
+
+		using Print::write;
+
+		//! Moves the print cursor.
+		/*!
+		  \param [in] row is the row.
+		  \param [in] col is the column.
+		  \return Returns ALL_OK on success, ERROR_CODE_OUT_OF_RANGE if the digit is outside the framebuffer.
+	    */
+		uint8_t		setCursor(uint8_t row, uint8_t col);
+
+		//! Blanks all digits, clears all decimal points and moves the print cursor to row 0, column 0.
+		void		clear();
+
 	private:	/// Stuff private to the class. Don't touch!
 		/// SPI slave select pin.
 		int					m_slaveSelectPin;
@@ -368,52 +976,227 @@ class Seg7Display
 		/// Number of 7 segment LED's. Default value is 1.
 		uint8_t				m_segmentSize;
 		
-		/// Pointer to text to be displayed. This is implemented as a String object.
+		/// The framebuffer: text and 7SEG codes for every digit.
 		disp_t				m_disp;
 		
 		/// Pointer to used ASCII table. Set this pointer in the begin() method.
 		const unsigned char	*m_ascii_table;
-		
-		/// member variables to keep track of time when text is scrolling on the upper display.
-		scroll_t			m_scrollUpper;
 
-		/// member variables to keep track of time when text is scrolling on the lower display.
-		scroll_t			m_scrollLower;
+		/// Fallback tables, searched in order after m_ascii_table. NULL for unused entries.
+		const unsigned char	*m_fallback[SEG7_FONT_FALLBACKS];
+
+		/// SEG7_FONT_xxx substitution rules.
+		uint8_t				m_fontRules;
+
+		/// The resolved 7SEG code for every character. Rebuilt by helperFontResolve().
+		uint8_t				m_font[SEG7_FONT_SIZE];
+
+		/// Bit per character set with setGlyph(). These entries are kept when the cache is rebuilt.
+		uint8_t				m_fontOverride[SEG7_FONT_SIZE/8];
 		
-		/// member variable containing information about any decimal point to be set in a 2*4 digit display.
-		/// 0x01 == lower left, 0x08 == lower right, 0x10 == upper left, 0x80 == upper right.
+		/// member variables to keep track of time for the regions that are scrolling. delay is 0 for free entries.
+		scroll_t			m_scroll[SEG7_MAX_SCROLLS];
+		
+		/// member variable containing information about any decimal point to be set, one bit per digit.
+		/// For a 2*4 digit display 0x80 == upper left, 0x10 == upper right, 0x08 == lower left, 0x01 == lower right.
 		/// Example: 0x23 would light up the two right most points in the lower display and the second right point in the upper display.
-		uint8_t				m_dps;
+		seg7Mask_t			m_dps;
+		
+		/// Time source, millis() unless changed with setClock().
+		seg7Clock_t			m_clock;
+
+		/// Bus output hook, NULL for the SPI bus.
+		seg7Bus_t			m_bus;
+
+		/// Context pointer passed to m_bus.
+		void*				m_busCtx;
+
+		/// Most segments lit at once, 0 for no limit.
+		uint8_t				m_segmentBudget;
+
+		/// Sub-frames per scan slot in the last refresh().
+		uint8_t				m_subFrames;
+
+		/// Most segments lit at once per scan slot in the last refresh().
+		uint8_t				m_slotLoad[8];
+		
+		/// Pending writes when update coalescing is on.
+		coalesce_t			m_coalesce;
+		
+		/// Command queue drained by refresh(), or NULL.
+		Seg7CommandQueue*	m_queue;
+		
+		/// DISPLAY_UPPER and/or DISPLAY_LOWER bits for counters written without leading zeros.
+		uint8_t				m_blankZeros;
+
+		/// Print cursor, the index of the next digit print() writes.
+		uint8_t				m_cursor;
+
+		/// True if the digit before the cursor was just printed and can take a '.' as its decimal point.
+		uint8_t				m_cursorDot;
+
+		/// True if the last print() filled a row. The cursor is already on the next row, so a '\n' now only clears this.
+		uint8_t				m_cursorWrap;
 		
 		/// member variable containing information about blink interval for a 2*4 digit display.
 		blink_t				m_blink;
 		
-		/// Helper method to decode ASCII tables.
+		/// Full time of the last blink check. The 16 bit deadlines cannot tell a gap of more than 32767 ms.
+		unsigned long		m_lastBlink;
+		
+		/// True once begin() has looked for the boot frame. Later begin() calls only switch the table.
+		uint8_t				m_booted;
+		
+		/// Helper method to decode one character with the resolved font.
 		uint8_t 			asciiTo7seg(char ch);				
 
-		/// Helper writer method to write to upper, lower or both displays.
-		void 				helperWrite(String& txt, char* buf, uint8_t len);
+		//! Looks a character up in the begin() table and the fallback tables.
+		/*!
+		  \param [in] ch is the character.
+		  \param [in] fold is true (not 0) to also try the other case of a letter.
+		  \return Returns the 7SEG code, 0 if no table has the character.
+	    */
+		uint8_t 			helperFontLookup(uint8_t ch, uint8_t fold);
+
+		//! Rebuilds the font cache and re-encodes the digits that show a character.
+		void 				helperFontResolve();
+
+		//! Helper writer method to write text to a run of digits, padding with blanks.
+		/*!
+		  \param [in] txt is the text.
+		  \param [in] n is the number of characters in txt. Extra characters are ignored.
+		  \param [in] first is the index of the first digit.
+		  \param [in] len is the number of digits to write.
+	    */
+		void 				helperWrite(const char* txt, unsigned int n, uint8_t first, uint8_t len);
+
+		//! Prints one character at the cursor.
+		/*!
+		  \param [in] ch is the character.
+		  \return Returns 1 if the character was used, 0 if the framebuffer is full.
+	    */
+		uint8_t 			helperPrint(uint8_t ch);
+
+		//! Sets one digit and its decimal point for print(), or records them as pending when coalescing.
+		/*!
+		  \param [in] i is the digit index.
+		  \param [in] ch is the character, or '\0' to keep the character and only set the decimal point.
+		  \param [in] dp is true (not 0) to light the decimal point.
+	    */
+		void 				helperPrintDigit(uint8_t i, char ch, uint8_t dp);
+
+		//! Clears and sets decimal points, or records them as pending when coalescing.
+		/*!
+		  \param [in] clear is the decimal points to turn off.
+		  \param [in] set is the decimal points to turn on.
+	    */
+		void 				helperSetDps(seg7Mask_t clear, seg7Mask_t set);
+
+		//! Gets the mask bits for a run of digits.
+		static seg7Mask_t	helperSpanMask(uint8_t first, uint8_t len);
+
+		//! Converts a legacy 8 bit digit mask (0x80 == first digit) to a seg7Mask_t.
+		static seg7Mask_t	helperLegacyMask(uint8_t mask) { return (seg7Mask_t)mask << (SEG7_MASK_BITS-8); }
+
+		//! Gets the digit mask of a rectangular region, or 0 if it is outside the framebuffer.
+		seg7Mask_t			helperRegionMask(uint8_t row, uint8_t col, uint8_t width, uint8_t height);
+
+		//! Gets the first digit and the number of digits for DISPLAY_UPPER, DISPLAY_LOWER or both.
+		/*!
+		  \param [in] displays is the display selection.
+		  \param [out] first is the index of the first digit.
+		  \return Returns the number of digits, 0 if no display was selected or the row does not exist.
+	    */
+		uint8_t 			helperRow(uint8_t displays, uint8_t& first);
+
+		//! Writes a raw segment code to one digit if it differs from what is there.
+		/*!
+		  Anything pending for the digit is dropped, this write is newer.
+		  \param [in] i is the digit index.
+		  \param [in] code is the 7SEG code to show.
+	    */
+		void 				helperWriteCode(uint8_t i, uint8_t code);
+
+		//! Writes one character to one digit if it differs from what is there.
+		/*!
+		  Anything pending for the digit is dropped, this write is newer.
+		  \param [in] i is the digit index.
+		  \param [in] ch is the character to show.
+	    */
+		void 				helperSetDigit(uint8_t i, char ch);
+
+		//! Gets the latest character written to a digit, also if it is still pending.
+		/*!
+		  \param [in] i is the digit index.
+		  \return Returns the character, '\0' for a raw segment pattern.
+	    */
+		char 				helperText(uint8_t i);
+
+		//! Clears and sets decimal points right away, and in the pending points when coalescing.
+		/*!
+		  \param [in] clear is the mask of points to clear.
+		  \param [in] set is the mask of points to set.
+	    */
+		void 				helperWriteDps(seg7Mask_t clear, seg7Mask_t set);
+
+		//! Sets blink times for the digits in the mask, starting the blink at time t.
+		void 				helperSetBlink(seg7Mask_t digit, unsigned int on, unsigned int off, unsigned long t);
+
+		//! Applies pending coalesced writes to the display buffers.
+		void 				helperApplyPending();
+
+		//! Restores the boot frame from EEPROM if there is a valid one.
+		/*!
+		  \return Returns true if a frame was restored.
+	    */
+		bool 				restoreBootFrame();
+
+		//! Toggles the blink groups whose deadline has passed and updates the visible mask.
+		/*!
+		  \param [in] now is the time from m_clock.
+	    */
+		void 				helperBlink(unsigned long now);
+
+		//! Rebuilds m_blink.visible from the groups that are off.
+		void 				helperBlinkMask();
+
+		//! Applies one command taken from the command queue.
+		void 				applyCommand(const seg7Command_t& cmd);
 
 		//! Function to check if there is scrolling text to display.
 		/*!
 		  \param [in] scroll is the scroll object.
-		  \param [in] disp is the display object.
-		 * \sa scrollUpper and scrollLower for how to set up scrolling text.
+		 * \sa scrollRegionEx and scrollRegionStream for how to set up scrolling text.
 	    */
-		void 				helperScroll(scroll_t& scroll, char *disp);
+		void 				helperScroll(scroll_t& scroll);
 
-		//! Function to set up scrolling text for the upper or lower display.
+		//! Finds the scroll entry for a region, and blanks the region for a new scroll.
 		/*!
-		  \param [in] str is the string to scroll.
-		  \param [in] scroll is the scroll object.
-		  \param [in] disp is the display object.
-		  \param [in] t is the scroll delay time in milliseconds.
-		  \param [in] left is true (not 0) for left scroll. Otherwise we scroll to the right.
-		 * \sa scrollUpper and scrollLower for how to set up scrolling text.
+		  \param [in] row is the row of the region.
+		  \param [in] col is the left column of the region.
+		  \param [in] width is the number of digits in the region.
+		  \return Returns the scroll entry, reusing the one for the same region or a free one.
+		  NULL if the region is outside the framebuffer or no entry is free.
 	    */
-		void 				helperSetupScroll(String& str, scroll_t& scroll, char *disp, unsigned int t, uint8_t left);
-		
-		void 				sendSPImessage(unsigned char ch, unsigned char pos);
+		scroll_t* 			helperSetupScroll(uint8_t row, uint8_t col, uint8_t width);
+
+		//! Sends all scan slots split into sub-frames that stay within m_segmentBudget.
+		/*!
+		  \param [in] slots is the number of scan slots.
+		  \param [in] modules is the number of modules in the chain.
+	    */
+		void 				helperScanBudget(uint8_t slots, uint8_t modules);
+
+		//! Gets the code digit d shows: its 7SEG code and decimal point, or 0 if blinked off or not in use.
+		uint8_t 			helperGlyph(uint8_t d);
+
+		//! Sends one scan slot: one 7SEG code per module, daisy-chained in one SS frame.
+		/*!
+		  \param [in] codes holds one code per module. The code for module 0 is sent last.
+		  \param [in] modules is the number of modules in the chain.
+		  \param [in] pos is the digit select byte for the slot. 0x80 = first digit of each module.
+	    */
+		void 				sendSPImessage(const uint8_t* codes, uint8_t modules, unsigned char pos);
 };
 
 #endif // Seg7Display_h
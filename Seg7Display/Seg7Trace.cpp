@@ -0,0 +1,94 @@
+/**
+ * @file   Seg7Trace.cpp
+ * @brief  Optional trace points for timing the Seg7Display library.
+ *
+ * @license
+ * ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include <Seg7Trace.h>
+
+static_assert((SEG7_TRACE_SIZE & (SEG7_TRACE_SIZE-1)) == 0, "SEG7_TRACE_SIZE must be a power of two");
+
+#ifdef SEG7_TRACE
+
+/// The trace ring buffer and the total number of records added.
+static seg7TraceRecord_t	s_trace[SEG7_TRACE_SIZE];
+static uint16_t				s_traceCount = 0;
+
+// Add one record, overwriting the oldest when the ring is full.
+void seg7TraceAdd(uint8_t id)
+{
+	seg7TraceRecord_t& rec = s_trace[s_traceCount & (SEG7_TRACE_SIZE-1)];
+#if defined(ESP8266) || defined(ESP32)
+	rec.time = ESP.getCycleCount();
+#else
+	rec.time = micros();
+#endif
+	rec.id = id;
+	s_traceCount++;
+}
+
+#endif // SEG7_TRACE
+
+// Copy the records out of the ring, oldest first.
+uint16_t seg7TraceCopy(seg7TraceRecord_t* out, uint16_t max)
+{
+#ifdef SEG7_TRACE
+	uint16_t count = (s_traceCount < SEG7_TRACE_SIZE) ? s_traceCount : SEG7_TRACE_SIZE;
+	uint16_t first = s_traceCount - count;
+	if( count > max ) {
+		first += count - max;
+		count = max;
+	}
+	for( uint16_t i=0; i<count; i++) {
+		out[i] = s_trace[(first + i) & (SEG7_TRACE_SIZE-1)];
+	}
+	return count;
+#else
+	(void)out;
+	(void)max;
+	return 0;
+#endif
+}
+
+// Pair entry and exit records and print a log2 latency histogram per function.
+void seg7TraceHistogram(const seg7TraceRecord_t* rec, uint16_t count, Print& out)
+{
+	static const char* const names[SEG7_TRACE_EVENTS] = { "refresh", "scroll", "blink", "decode", "spi" };
+	uint16_t hist[SEG7_TRACE_EVENTS][16];
+	uint32_t enter[SEG7_TRACE_EVENTS];
+	uint8_t  open = 0;				// Bit per event id with an entry but no exit yet.
+
+	memset(hist, 0, sizeof(hist));
+	for( uint16_t i=0; i<count; i++) {
+		uint8_t id = rec[i].id & ~SEG7_TRACE_EXIT;
+		if( id >= SEG7_TRACE_EVENTS ) {
+			continue;
+		}
+		if( !(rec[i].id & SEG7_TRACE_EXIT) ) {
+			enter[id] = rec[i].time;
+			open |= 1 << id;
+		} else if( open & (1 << id) ) {
+			// An exit without its entry (lost when the ring wrapped) is skipped.
+			uint32_t ticks = rec[i].time - enter[id];
+			uint8_t bucket = 0;
+			while( ticks > 1 && bucket < 15 ) {
+				ticks >>= 1;
+				bucket++;
+			}
+			hist[id][bucket]++;
+			open &= ~(1 << id);
+		}
+	}
+
+	for( uint8_t id=0; id<SEG7_TRACE_EVENTS; id++) {
+		out.print(names[id]);
+		for( uint8_t b=0; b<16; b++) {
+			out.print(b ? ' ' : ':');
+			out.print(hist[id][b]);
+		}
+		out.println();
+	}
+}
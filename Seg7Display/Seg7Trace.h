@@ -0,0 +1,123 @@
+/**
+ * @file   Seg7Trace.h
+ * @brief  Optional trace points for timing the Seg7Display library.
+ *
+ * Define SEG7_TRACE when building the library to record an entry and an exit event for
+ * refresh(), helperScroll(), the blink toggle logic, asciiTo7seg() and sendSPImessage()
+ * into a fixed ring buffer. Without SEG7_TRACE all trace points compile to nothing.
+ *
+ * Each record holds an event id and a timestamp. The timestamp is the CPU cycle counter
+ * where the core has one (ESP8266, ESP32) and micros() elsewhere.
+ *
+ * seg7TraceHistogram() pairs the entry and exit records and prints a latency histogram per
+ * function. It only needs a Print, so it can run on the target (e.g. to Serial) or on a host
+ * after copying the buffer out with seg7TraceCopy().
+ *
+ * @license
+ * ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ */
+
+#ifndef Seg7Trace_h
+#define Seg7Trace_h
+
+#include "Arduino.h"
+
+/*! \def SEG7_TRACE_SIZE
+ *  \brief Number of records in the trace ring buffer. Must be a power of two.
+ */
+#ifndef SEG7_TRACE_SIZE
+#define SEG7_TRACE_SIZE						64
+#endif
+
+/*! \def SEG7_TRACE_REFRESH
+ *  \brief Event id for Seg7Display::refresh().
+ *
+ *  \def SEG7_TRACE_SCROLL
+ *  \brief Event id for Seg7Display::helperScroll().
+ *
+ *  \def SEG7_TRACE_BLINK
+ *  \brief Event id for the blink group toggle logic.
+ *
+ *  \def SEG7_TRACE_DECODE
+ *  \brief Event id for Seg7Display::asciiTo7seg().
+ *
+ *  \def SEG7_TRACE_SPI
+ *  \brief Event id for Seg7Display::sendSPImessage().
+ *
+ *  \def SEG7_TRACE_EVENTS
+ *  \brief Number of event ids.
+ *
+ *  \def SEG7_TRACE_EXIT
+ *  \brief Or:ed with the event id in exit records.
+ */
+#define SEG7_TRACE_REFRESH					0
+#define SEG7_TRACE_SCROLL					1
+#define SEG7_TRACE_BLINK					2
+#define SEG7_TRACE_DECODE					3
+#define SEG7_TRACE_SPI						4
+#define SEG7_TRACE_EVENTS					5
+#define SEG7_TRACE_EXIT						0x80
+
+/**
+ * \struct seg7TraceRecord
+ *
+ * One trace record.
+ */
+typedef struct seg7TraceRecord {
+	uint32_t		time;		/*!< Cycle counter or micros() when the event happened. */
+	uint8_t			id;			/*!< SEG7_TRACE_xxx, or:ed with SEG7_TRACE_EXIT on exit. */
+}seg7TraceRecord_t;				/*!< typedef for structure seg7TraceRecord */
+
+//! Copies the recorded events, oldest first, out of the ring buffer.
+/*!
+  \param [out] out receives up to max records.
+  \param [in] max is the size of out.
+  \return Returns the number of records copied. Always 0 without SEG7_TRACE.
+*/
+uint16_t	seg7TraceCopy(seg7TraceRecord_t* out, uint16_t max);
+
+//! Prints a latency histogram per function from a list of trace records.
+/*!
+  Latencies are put in power of two buckets of the timestamp unit: bucket n counts calls
+  that took [2^n, 2^(n+1)) ticks, bucket 0 also counts 0.
+  \param [in] rec is the records, oldest first, e.g. from seg7TraceCopy().
+  \param [in] count is the number of records.
+  \param [in] out is where the histogram is printed.
+*/
+void		seg7TraceHistogram(const seg7TraceRecord_t* rec, uint16_t count, Print& out);
+
+#ifdef SEG7_TRACE
+
+//! Adds one record to the trace ring buffer. Use the SEG7_TRACE_SCOPE macro instead.
+void		seg7TraceAdd(uint8_t id);
+
+/**
+ * \class Seg7TraceScope
+ *
+ * \brief Records an entry event when created and the exit event when it goes out of scope.
+ */
+class Seg7TraceScope
+{
+	public:
+		//! Records the entry event.
+		Seg7TraceScope(uint8_t id) : m_id(id) { seg7TraceAdd(id); }
+
+		//! Records the exit event.
+		~Seg7TraceScope() { seg7TraceAdd(m_id | SEG7_TRACE_EXIT); }
+
+	private:
+		uint8_t		m_id;
+};
+
+/*! \def SEG7_TRACE_SCOPE
+ *  \brief Traces the rest of the enclosing scope as event id. Nothing without SEG7_TRACE.
+ */
+#define SEG7_TRACE_SCOPE(id)				Seg7TraceScope seg7TraceScope_(id)
+
+#else
+
+#define SEG7_TRACE_SCOPE(id)
+
+#endif // SEG7_TRACE
+
+#endif // Seg7Trace_h
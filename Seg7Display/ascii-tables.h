@@ -286,4 +286,35 @@ const unsigned char ASCII_FULL_TAB[] =
     0x00        // 'z', No seven-segment implementation
 };
 
+/** Look-alike substitutions for characters that have no 7SEG implementation.
+ * Each pair is { character, character drawn instead }. Used by Seg7Display when
+ * SEG7_FONT_LOOKALIKE is set with setFontRules(). The list ends with { 0, 0 }.
+ */
+const char LOOKALIKE_CHARS[][2] =
+ {
+	{ 'K', 'H' },
+	{ 'k', 'h' },
+	{ 'V', 'U' },
+	{ 'v', 'u' },
+	{ 'X', 'H' },
+	{ 'x', 'h' },
+	{ 'Z', '2' },
+	{ 'z', '2' },
+	{ 'O', '0' },
+	{ 'o', '0' },
+	{ 'I', '1' },
+	{ 'l', '1' },
+	{ 'S', '5' },
+	{ 's', '5' },
+	{ 'G', '6' },
+	{ 'B', '8' },
+	{ 'g', '9' },
+	{ '[', '(' },
+	{ ']', ')' },
+	{ '{', '(' },
+	{ '}', ')' },
+	{ '|', '1' },
+	{ 0, 0 }
+};
+
 #endif // ASCII_TABLES_H
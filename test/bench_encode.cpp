@@ -0,0 +1,113 @@
+/**
+ * @file   bench_encode.cpp
+ * @date   October, 2026
+ * @brief  Host microbenchmark of encode() against a plain lookup per character.
+ *
+ * For every begin() table, text made of that table's characters is encoded in spans of
+ * 8, 32 and 1000 characters, and the time per character is printed for encode() and for the
+ * same loop (one range check and one font load per character) inlined here, so the gap is
+ * the cost of the call. The two must give the same codes. The optional argument is the number of passes;
+ * ctest runs a short one so the benchmark also works as a test.
+ *
+ *		bench_encode 200000
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include <Seg7Display.h>
+#include "harness.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#define MAX_SPAN	1000
+
+typedef std::chrono::steady_clock benchClock_t;
+
+/**
+ * \struct benchTable
+ *
+ * One begin() table and the characters it is normally fed.
+ */
+typedef struct benchTable {
+	const char*				name;
+	const unsigned char*	table;
+	const char*				chars;
+}benchTable_t;
+
+static const benchTable_t tables[] = {
+	{ "ASCII_NUM_TAB",  ASCII_NUM_TAB,  "0123456789 -." },
+	{ "ASCII_HEX_TAB",  ASCII_HEX_TAB,  "0123456789ABCDEFabcdef -" },
+	{ "ASCII_FULL_TAB", ASCII_FULL_TAB, " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~" },
+	{ "FULL + 8 bit",   ASCII_FULL_TAB, "Temp 21.5\xB0" "C caf\xE9" },
+};
+
+// Keeps the compiler from dropping the work.
+static volatile uint8_t sink;
+
+// Nanoseconds per character to encode len characters passes times with encode().
+static double timeEncode(Seg7Display& seg, const char* txt, unsigned int len, uint8_t* out, unsigned long passes)
+{
+	benchClock_t::time_point t0 = benchClock_t::now();
+	for( unsigned long p=0; p<passes; p++) {
+		seg.encode(txt, len, out);
+		sink = out[p % len];
+	}
+	benchClock_t::time_point t1 = benchClock_t::now();
+	return std::chrono::duration<double, std::nano>(t1 - t0).count() / ((double)passes * len);
+}
+
+// Nanoseconds per character for the same work with a plain lookup in a copy of the font.
+static double timeLookup(const uint8_t* font, const char* txt, unsigned int len, uint8_t* out, unsigned long passes)
+{
+	benchClock_t::time_point t0 = benchClock_t::now();
+	for( unsigned long p=0; p<passes; p++) {
+		for( unsigned int i=0; i<len; i++) {
+			uint8_t c = (uint8_t)txt[i];
+			out[i] = (c < SEG7_FONT_SIZE) ? font[c] : 0;
+		}
+		sink = out[p % len];
+	}
+	benchClock_t::time_point t1 = benchClock_t::now();
+	return std::chrono::duration<double, std::nano>(t1 - t0).count() / ((double)passes * len);
+}
+
+int main(int argc, char** argv)
+{
+	static const unsigned int spans[] = { 8, 32, MAX_SPAN };
+	unsigned long passes = (argc > 1) ? strtoul(argv[1], NULL, 10) : 2000;
+	harnessRandom_t rnd = { 0x5EC7 };
+	char txt[MAX_SPAN];
+	char all[SEG7_FONT_SIZE];
+	uint8_t font[SEG7_FONT_SIZE];
+	uint8_t out[2][MAX_SPAN];
+
+	for( unsigned int c=0; c<SEG7_FONT_SIZE; c++) {
+		all[c] = (char)c;
+	}
+
+	printf("%-15s %5s %12s %12s\n", "table", "span", "encode ns/ch", "lookup ns/ch");
+	for( uint8_t t=0; t<sizeof(tables)/sizeof(tables[0]); t++) {
+		Seg7Display seg;
+		seg.begin(10, tables[t].table);
+		seg.encode(all, SEG7_FONT_SIZE, font);
+		unsigned int n = strlen(tables[t].chars);
+		for( unsigned int i=0; i<MAX_SPAN; i++) {
+			txt[i] = tables[t].chars[harnessRand(rnd, n)];
+		}
+
+		for( uint8_t s=0; s<sizeof(spans)/sizeof(spans[0]); s++) {
+			unsigned int len = spans[s];
+			// Same amount of characters for every span.
+			unsigned long reps = passes * 32 / len + 1;
+			double enc = timeEncode(seg, txt, len, out[0], reps);
+			double chr = timeLookup(font, txt, len, out[1], reps);
+			CHECK(memcmp(out[0], out[1], len) == 0);
+			printf("%-15s %5u %12.2f %12.2f\n", tables[t].name, len, enc, chr);
+		}
+	}
+	return harnessResult("bench_encode");
+}
@@ -0,0 +1,144 @@
+/**
+ * @file   harness.cpp
+ * @date   October, 2026
+ * @brief  Virtual-clock test harness for the Seg7Display host tests.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include "harness.h"
+#include "ascii-tables.h"
+
+unsigned long harnessNow = 0;
+
+static unsigned long checks = 0;
+static unsigned long failures = 0;
+
+// Record a check, print the first failures.
+bool harnessCheck(bool cond, const char* file, int line, const char* what)
+{
+	checks++;
+	if( !cond ) {
+		if( ++failures <= 20 ) {
+			printf("%s:%d: FAILED: %s (t=%lu)\n", file, line, what, harnessNow);
+		}
+	}
+	return cond;
+}
+
+// Record a string compare, print both strings on failure.
+bool harnessCheckStr(const std::string& a, const std::string& b, const char* file, int line, const char* what)
+{
+	bool equal = (a == b);
+	if( !harnessCheck(equal, file, line, what) && failures <= 20 ) {
+		printf("    got      %s\n    expected %s\n", a.c_str(), b.c_str());
+	}
+	return equal;
+}
+
+// Print a summary and return the exit code.
+int harnessResult(const char* name)
+{
+	printf("%s: %lu checks, %lu failed\n", name, checks, failures);
+	return failures ? 1 : 0;
+}
+
+// Clock for setClock().
+unsigned long harnessClock()
+{
+	return harnessNow;
+}
+
+// xorshift32.
+uint32_t harnessRand(harnessRandom_t& r, uint32_t n)
+{
+	uint32_t x = r.state ? r.state : 0x9E3779B9UL;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	r.state = x;
+	return n ? x % n : x;
+}
+
+// Append hook words to the capture.
+void captureBus(void* ctx, const uint16_t* words, uint8_t count)
+{
+	frameCapture_t& cap = *(frameCapture_t*)ctx;
+	cap.words.insert(cap.words.end(), words, words + count);
+}
+
+// Move the SPI log into the capture.
+void captureSPI(frameCapture_t& cap)
+{
+	cap.words.insert(cap.words.end(), SPI.log.begin(), SPI.log.end());
+	SPI.log.clear();
+}
+
+// Decode the last scan in the capture.
+std::vector<uint8_t> takeFrame(frameCapture_t& cap, uint8_t digits)
+{
+	std::vector<uint8_t> codes(digits, 0);
+	uint8_t modules = cap.modules ? cap.modules : 1;
+	int lastSlot = -1;
+	
+	for( size_t w=0; w+modules<=cap.words.size(); w+=modules) {
+		uint8_t pos = cap.words[w] & 0xFF;
+		int slot = 0;
+		while( slot<8 && pos != (0x80>>slot) ) {
+			slot++;
+		}
+		if( slot < lastSlot ) {
+			codes.assign(digits, 0);			// A new scan starts.
+		}
+		// The word for the last module goes out first.
+		for( uint8_t m=0; m<modules; m++) {
+			uint8_t d = (modules-1-m)*8 + slot;
+			if( d < digits ) {
+				codes[d] = (slot == lastSlot) ? codes[d] | (cap.words[w+m] >> 8) : (cap.words[w+m] >> 8);
+			}
+		}
+		lastSlot = slot;
+	}
+	cap.words.clear();
+	return codes;
+}
+
+// Hex dump of a frame.
+std::string frameHex(const std::vector<uint8_t>& codes)
+{
+	static const char hex[] = "0123456789ABCDEF";
+	std::string s;
+	for( size_t i=0; i<codes.size(); i++) {
+		s += hex[codes[i] >> 4];
+		s += hex[codes[i] & 0x0F];
+	}
+	return s;
+}
+
+// Straight table lookup, independent of the library's font cache.
+uint8_t tableCode(const unsigned char* table, char ch)
+{
+	uint8_t c = (uint8_t)ch;
+	if( c >= table[0] && c <= table[1] ) {
+		return table[c - table[0] + 2];
+	}
+	if( c < 32 ) {
+		return SPECIAL_CHARS[c];
+	}
+	return 0;
+}
+
+// Expected frame for a text. The first digit is the highest bit of dps and dark, as in setBlink().
+std::string textFrame(const unsigned char* table, const char* text, uint32_t dps, uint32_t dark)
+{
+	std::vector<uint8_t> codes;
+	size_t len = strlen(text);
+	for( size_t i=0; i<len; i++) {
+		uint32_t bit = 1UL << (len-1-i);
+		uint8_t code = tableCode(table, text[i]) | ((dps & bit) ? 0x01 : 0x00);
+		codes.push_back((dark & bit) ? 0x00 : code);
+	}
+	return frameHex(codes);
+}
@@ -0,0 +1,86 @@
+/**
+ * @file   harness.h
+ * @date   October, 2026
+ * @brief  Virtual-clock test harness for the Seg7Display host tests.
+ *
+ * The tests run the library against the mock Arduino core in mock/. Time only moves
+ * when a test moves it, and the frames sent on the bus are decoded back to one
+ * 7SEG code per digit, so whole schedules can be checked frame by frame.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#ifndef Seg7Harness_h
+#define Seg7Harness_h
+
+#include <string>
+#include <vector>
+#include "Arduino.h"
+#include "SPI.h"
+
+/// Check a condition, report it if it fails and go on. The test exits with harnessResult().
+#define CHECK(cond)			harnessCheck((cond), __FILE__, __LINE__, #cond)
+
+/// Check that two strings are equal and show both if they are not.
+#define CHECK_STR(a, b)		harnessCheckStr((a), (b), __FILE__, __LINE__, #a)
+
+/// Record a check. Returns cond.
+bool			harnessCheck(bool cond, const char* file, int line, const char* what);
+
+/// Record a string compare. Returns true if they are equal.
+bool			harnessCheckStr(const std::string& a, const std::string& b, const char* file, int line, const char* what);
+
+/// Print a summary and return the exit code for main().
+int				harnessResult(const char* name);
+
+/// Time for the harness clock, in milliseconds. Set it or step it, the library reads it through harnessClock().
+extern unsigned long harnessNow;
+
+/// A seg7Clock_t that reads harnessNow.
+unsigned long	harnessClock();
+
+/// Small deterministic random generator, so runs are the same on every host.
+typedef struct harnessRandom {
+	uint32_t	state;
+}harnessRandom_t;
+
+/// Next number in [0, n).
+uint32_t		harnessRand(harnessRandom_t& r, uint32_t n);
+
+/**
+ * \struct frameCapture
+ *
+ * Collects bus words, from the SPI log or from a seg7Bus_t hook, and decodes them
+ * to the code every digit shows.
+ */
+typedef struct frameCapture {
+	std::vector<uint16_t>	words;			/*!< Words since the last frame was taken, in bus order. */
+	uint8_t					modules;		/*!< Number of 8 digit modules in the chain. */
+}frameCapture_t;
+
+/// A seg7Bus_t that appends the words to the frameCapture_t in ctx.
+void			captureBus(void* ctx, const uint16_t* words, uint8_t count);
+
+/// Move the words logged by the SPI mock into the capture.
+void			captureSPI(frameCapture_t& cap);
+
+/**
+ * Decode the words of the capture to one code per digit and clear it.
+ * Sub-frames of one slot are ORed. A slot number lower than the one before starts a
+ * new scan, so only the last scan in the capture counts. Digits never sent are 0.
+ */
+std::vector<uint8_t>	takeFrame(frameCapture_t& cap, uint8_t digits);
+
+/// Upper case hex of the codes, two characters per digit.
+std::string		frameHex(const std::vector<uint8_t>& codes);
+
+/// 7SEG code of ch in a begin() table, the special characters for ch < 32, else 0.
+uint8_t			tableCode(const unsigned char* table, char ch);
+
+/// Expected hex frame for a text, one character per digit. dps and dark are digit masks with
+/// the first digit in the highest bit, e.g. 0x80 for the upper left digit of the 2*4 shield.
+std::string		textFrame(const unsigned char* table, const char* text, uint32_t dps = 0, uint32_t dark = 0);
+
+#endif // Seg7Harness_h
@@ -0,0 +1,98 @@
+/**
+ * @file   Arduino.cpp
+ * @date   October, 2026
+ * @brief  Host stand-in for the Arduino core, used by the Seg7Display host tests.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include "Arduino.h"
+#include "SPI.h"
+
+unsigned long mockMicros = 0;
+long mockStringHeap = 0;
+SPIClass SPI;
+
+// Write a buffer one byte at a time, stop at the first byte that is not taken.
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+	size_t n = 0;
+	while( size-- ) {
+		if( !write(*buffer++) ) {
+			break;
+		}
+		n++;
+	}
+	return n;
+}
+
+// Print a signed number. Only base 10 gets a minus sign, as on Arduino.
+size_t Print::print(long n, int base)
+{
+	if( base == DEC && n < 0 ) {
+		size_t t = print('-');
+		return t + printNumber(-(unsigned long)n, DEC);
+	}
+	return printNumber((unsigned long)n, base);
+}
+
+// Print an unsigned number.
+size_t Print::print(unsigned long n, int base)
+{
+	return printNumber(n, base);
+}
+
+// Print a float the way the Arduino core does: round, then print the digits one by one.
+size_t Print::print(double number, int digits)
+{
+	size_t n = 0;
+	
+	if( number != number ) return print("nan");
+	if( number > 4294967040.0 || number < -4294967040.0 ) return print("ovf");
+	
+	if( number < 0.0 ) {
+		n += print('-');
+		number = -number;
+	}
+	
+	double rounding = 0.5;
+	for( int i=0; i<digits; i++) {
+		rounding /= 10.0;
+	}
+	number += rounding;
+	
+	unsigned long whole = (unsigned long)number;
+	double rest = number - (double)whole;
+	n += print(whole);
+	
+	if( digits > 0 ) {
+		n += print('.');
+	}
+	while( digits-- > 0 ) {
+		rest *= 10.0;
+		unsigned int d = (unsigned int)rest;
+		n += print(d);
+		rest -= d;
+	}
+	return n;
+}
+
+// Print the digits of n in base, most significant first.
+size_t Print::printNumber(unsigned long n, uint8_t base)
+{
+	char buf[8 * sizeof(long) + 1];
+	char *str = &buf[sizeof(buf) - 1];
+	
+	*str = '\0';
+	if( base < 2 ) {
+		base = 10;
+	}
+	do {
+		char c = n % base;
+		n /= base;
+		*--str = (c < 10) ? c + '0' : c + 'A' - 10;
+	} while( n );
+	return write(str);
+}
@@ -0,0 +1,147 @@
+/**
+ * @file   Arduino.h
+ * @date   October, 2026
+ * @brief  Host stand-in for the Arduino core, used by the Seg7Display host tests.
+ *
+ * Only what the library and the tests use is here. millis(), micros() and delay() run
+ * on a virtual clock that the tests set and advance, so timing is deterministic.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#define LOW			0
+#define HIGH		1
+#define INPUT		0
+#define OUTPUT		1
+
+#define DEC			10
+#define HEX			16
+#define OCT			8
+#define BIN			2
+
+typedef bool		boolean;
+typedef uint8_t		byte;
+
+/// Virtual time in microseconds. millis() and micros() read it, delay() advances it.
+extern unsigned long mockMicros;
+
+inline unsigned long millis()				{ return mockMicros / 1000; }
+inline unsigned long micros()				{ return mockMicros; }
+inline void delay(unsigned long ms)			{ mockMicros += ms * 1000; }
+inline void delayMicroseconds(unsigned int us)	{ mockMicros += us; }
+
+/// Set the virtual clock to ms milliseconds.
+inline void mockSetMillis(unsigned long ms)	{ mockMicros = ms * 1000; }
+
+inline void pinMode(uint8_t, uint8_t)		{}
+inline void digitalWrite(uint8_t, uint8_t)	{}
+inline void noInterrupts()					{}
+inline void interrupts()					{}
+
+/// Heap bytes held by all String objects. Lets the tests see a String keep or free its buffer.
+extern long mockStringHeap;
+
+/**
+ * \class String
+ *
+ * The part of the Arduino String class the library uses, with its buffer rules: assigning
+ * text keeps a buffer that is big enough, even for "", and only NULL frees it.
+ */
+class String
+{
+	public:
+					String(const char *cstr = "") : m_heap(0)	{ if( cstr ) copy(cstr, strlen(cstr)); }
+					String(char c) : m_heap(0)					{ copy(&c, 1); }
+					String(const String& s) : m_heap(0)			{ *this = s; }
+					~String()									{ invalidate(); }
+		String&		operator=(const String& s)
+		{
+			if( this != &s ) {
+				if( s.m_heap ) {
+					copy(s.m_str.data(), s.m_str.size());
+				} else {
+					invalidate();
+				}
+			}
+			return *this;
+		}
+		String&		operator=(const char *cstr)
+		{
+			if( cstr ) {
+				copy(cstr, strlen(cstr));
+			} else {
+				invalidate();
+			}
+			return *this;
+		}
+		unsigned int	length() const				{ return m_str.size(); }
+		char		charAt(unsigned int i) const	{ return (i < m_str.size()) ? m_str[i] : 0; }
+		void		remove(unsigned int i)			{ if( i < m_str.size() ) m_str.erase(i); }
+		const char*	c_str() const					{ return m_heap ? m_str.c_str() : NULL; }
+		String&		operator+=(const String& s)		{ reserve(m_str.size() + s.m_str.size()); m_str += s.m_str; return *this; }
+		String&		operator+=(char c)				{ reserve(m_str.size() + 1); m_str += c; return *this; }
+		bool		operator==(const char* s) const	{ return m_str == (s ? s : ""); }
+		
+	private:
+		// Grow the buffer to hold n characters and the terminator. It never shrinks.
+		void		reserve(unsigned int n)
+		{
+			if( m_heap > n ) {
+				return;
+			}
+			mockStringHeap += (long)(n + 1) - (long)m_heap;
+			m_heap = n + 1;
+		}
+		void		copy(const char *cstr, unsigned int n)	{ reserve(n); m_str.assign(cstr, n); }
+		void		invalidate()					{ mockStringHeap -= m_heap; m_heap = 0; m_str.clear(); }
+		
+		std::string		m_str;
+		unsigned int	m_heap;			/*!< Bytes allocated, 0 when the String has no buffer. */
+};
+
+/**
+ * \class Print
+ *
+ * The Arduino Print class: number and float formatting on top of write().
+ */
+class Print
+{
+	public:
+		virtual			~Print() {}
+		virtual size_t	write(uint8_t) = 0;
+		virtual size_t	write(const uint8_t *buffer, size_t size);
+		size_t			write(const char *str)					{ return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+		size_t			write(const char *buffer, size_t size)	{ return write((const uint8_t *)buffer, size); }
+		
+		size_t			print(const String &s)					{ return write(s.c_str()); }
+		size_t			print(const char *str)					{ return write(str); }
+		size_t			print(char c)							{ return write((uint8_t)c); }
+		size_t			print(unsigned char n, int base = DEC)	{ return print((unsigned long)n, base); }
+		size_t			print(int n, int base = DEC)			{ return print((long)n, base); }
+		size_t			print(unsigned int n, int base = DEC)	{ return print((unsigned long)n, base); }
+		size_t			print(long n, int base = DEC);
+		size_t			print(unsigned long n, int base = DEC);
+		size_t			print(double n, int digits = 2);
+		
+		template<class T>
+		size_t			println(T v)							{ size_t n = print(v); return n + println(); }
+		template<class T>
+		size_t			println(T v, int f)						{ size_t n = print(v, f); return n + println(); }
+		size_t			println()								{ return write("\r\n"); }
+		
+	private:
+		size_t			printNumber(unsigned long n, uint8_t base);
+};
+
+#endif // Arduino_h
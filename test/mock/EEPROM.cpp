@@ -0,0 +1,13 @@
+/**
+ * @file   EEPROM.cpp
+ * @date   October, 2026
+ * @brief  The EEPROM object of the host stand-in. Built with each test, see EEPROM.h.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include "EEPROM.h"
+
+EEPROMClass EEPROM;
@@ -0,0 +1,87 @@
+/**
+ * @file   EEPROM.h
+ * @date   October, 2026
+ * @brief  Host stand-in for the AVR and ESP EEPROM libraries, used by the Seg7Display host tests.
+ *
+ * Without ESP8266 or ESP32 defined this is the AVR library: 1 KiB of erased (0xFF) EEPROM
+ * that is always there. With one of them defined it is the ESP library: begin() allocates a
+ * RAM copy of the emulated EEPROM, and calling it again drops the copy and any writes that
+ * were not committed, as the ESP8266 core does. mock/EEPROM.cpp is compiled into each test,
+ * so every test gets the flavour its own defines select.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#define MOCK_EEPROM_SIZE	1024
+
+#if defined(ESP8266) || defined(ESP32)
+
+/**
+ * \class EEPROMClass
+ *
+ * 1 KiB of erased flash behind a RAM buffer that begin() sizes.
+ */
+class EEPROMClass
+{
+	public:
+					EEPROMClass()					{ memset(flash, 0xFF, sizeof(flash)); begins = 0; }
+		void		begin(size_t size)
+		{
+			if( size == 0 || size > sizeof(flash) ) {
+				return;
+			}
+			begins++;
+			ram.assign(flash, flash + size);	// A new buffer, read back from flash.
+		}
+		uint8_t		read(int a)						{ return ((size_t)a < ram.size()) ? ram[a] : 0; }
+		void		write(int a, uint8_t v)			{ if( (size_t)a < ram.size() ) ram[a] = v; }
+		bool		commit()
+		{
+			if( ram.empty() ) {
+				return false;
+			}
+			memcpy(flash, ram.data(), ram.size());
+			return true;
+		}
+		bool		end()							{ bool ok = commit(); ram.clear(); return ok; }
+		size_t		length()						{ return ram.size(); }
+		
+		uint8_t					flash[MOCK_EEPROM_SIZE];
+		std::vector<uint8_t>	ram;
+		unsigned int			begins;			/*!< Number of begin() calls. */
+};
+
+#else
+
+/**
+ * \class EEPROMClass
+ *
+ * 1 KiB of erased (0xFF) EEPROM.
+ */
+class EEPROMClass
+{
+	public:
+					EEPROMClass()					{ memset(mem, 0xFF, sizeof(mem)); }
+		uint8_t		read(int a)						{ return mem[a]; }
+		void		write(int a, uint8_t v)			{ mem[a] = v; }
+		void		update(int a, uint8_t v)		{ if( mem[a] != v ) mem[a] = v; }
+		uint16_t	length()						{ return sizeof(mem); }
+		
+		uint8_t		mem[MOCK_EEPROM_SIZE];
+};
+
+#endif
+
+extern EEPROMClass EEPROM;
+
+#endif // EEPROM_h
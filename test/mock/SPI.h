@@ -0,0 +1,44 @@
+/**
+ * @file   SPI.h
+ * @date   October, 2026
+ * @brief  Host stand-in for the Arduino SPI library, used by the Seg7Display host tests.
+ *
+ * Every word sent with transfer16() is logged, so a test can decode the frames that
+ * would have gone out to the display.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#ifndef SPI_h
+#define SPI_h
+
+#include <stdint.h>
+#include <vector>
+
+#define SPI_MODE0		0x00
+#define LSBFIRST		0
+#define MSBFIRST		1
+
+/**
+ * \class SPIClass
+ *
+ * Logs the words sent on the bus.
+ */
+class SPIClass
+{
+	public:
+		void		begin()						{}
+		void		setDataMode(uint8_t)		{}
+		void		setBitOrder(uint8_t)		{}
+		uint8_t		transfer(uint8_t v)			{ log.push_back(v); return 0; }
+		uint16_t	transfer16(uint16_t v)		{ log.push_back(v); return 0; }
+		
+		/// Words sent since the log was last cleared, in bus order.
+		std::vector<uint16_t>	log;
+};
+
+extern SPIClass SPI;
+
+#endif // SPI_h
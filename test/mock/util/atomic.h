@@ -0,0 +1,42 @@
+/**
+ * @file   atomic.h
+ * @date   October, 2026
+ * @brief  Host stand-in for avr-libc's util/atomic.h, used by the Seg7Display host tests.
+ *
+ * An AVR is one core, and masking interrupts stops everything else, task switches included.
+ * Here every ATOMIC_BLOCK takes one global lock instead, so code written for AVR can be run
+ * under host threads with the same guarantee.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#ifndef MOCK_UTIL_ATOMIC_H
+#define MOCK_UTIL_ATOMIC_H
+
+#include <mutex>
+
+#define ATOMIC_RESTORESTATE		0
+
+/// The "interrupt flag" all ATOMIC_BLOCKs share.
+inline std::recursive_mutex& mockInterruptLock()
+{
+	static std::recursive_mutex lock;
+	return lock;
+}
+
+/**
+ * \struct mockAtomicGuard
+ *
+ * Holds the lock for one pass of the ATOMIC_BLOCK loop.
+ */
+typedef struct mockAtomicGuard {
+	bool	once;
+			mockAtomicGuard() : once(true)	{ mockInterruptLock().lock(); }
+			~mockAtomicGuard()				{ mockInterruptLock().unlock(); }
+}mockAtomicGuard_t;
+
+#define ATOMIC_BLOCK(type)		for( mockAtomicGuard_t atomicGuard_; atomicGuard_.once; atomicGuard_.once = false )
+
+#endif // MOCK_UTIL_ATOMIC_H
@@ -0,0 +1,120 @@
+/**
+ * @file   Seg7Reference.h
+ * @date   October, 2026
+ * @brief  Reference model of Seg7Display for the golden-frame tests.
+ *
+ * This is the original (2015) Seg7Display, renamed and put in namespace seg7ref so it can be
+ * linked next to the library. The golden frames in test/golden are recorded from it, and the
+ * random scenarios in test_golden.cpp compare the library with it frame by frame.
+ *
+ * Behaviour the library changed on purpose is changed here too, so the model shows the
+ * intended frames. Every such change is marked "CHANGE" with the request that made it:
+ *
+ *  - asciiTo7seg() decodes the first character of a table (it skipped '0' and ' ').	[user-029]
+ *  - helperWrite() pads the rest of a span with blanks. It skipped the first pad digit
+ *    and wrote one digit past the span.											[user-027]
+ *  - scrollLower() scrolls the lower row text, not the unterminated buffer.			[user-037]
+ *  - setBlink() does not block in delay(100). The digits start dark and light at the
+ *    first refresh() after the call, as they did after the delay.					[user-036]
+ *  - Blink deadlines advance from the previous deadline (phase-locked), and digits given
+ *    the timing of digits already blinking join them in phase.						[user-032]
+ *
+ * Only the 8 digit (2*4) display is modelled, as in the original.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#ifndef Seg7Reference_h
+#define Seg7Reference_h
+
+#include "Arduino.h"
+#include "ascii-tables.h"
+
+// Same values as in Seg7Display.h.
+#ifndef ALL_OK
+#define ALL_OK								0
+#define ERROR_CODE_INVALID_SS_PIN			2
+#define ERROR_CODE_TO_FEW_SEGMENTS			3
+#define ERROR_CODE_OUT_OF_RANGE				4
+#define DISPLAY_UPPER						0X01
+#define DISPLAY_LOWER						0X02
+#endif
+
+namespace seg7ref {
+
+/// Blink state per digit.
+typedef struct blinks {
+	unsigned long	on[8];			/*!< Containing time in milliseconds that blink is on. */
+	unsigned long	off[8];			/*!< Containing time in milliseconds that blink is off. */
+	unsigned long	nextToggle[8];	/*!< Containing time in milliseconds for next toggle. */
+	uint8_t			isOn[8];		/*!< True if the digit is on. */
+}blink_t;
+
+/// Text for the two 4 digit displays.
+typedef struct displays {
+	union {
+		char	upLo[8];			/*!< The eight digits for the upper and lower displays. */
+		struct {
+			char	upper[4];		/*!< The four digits for the upper display. */
+			char 	lower[4];		/*!< The four digits for the lower display. */
+		};
+	};
+}disp_t;
+
+/// Scroll state for one 4 digit display.
+typedef struct scroll {
+	unsigned long		time;		/*!< The time (milliseconds) when the scroll text was updated last time. */
+	String				text;		/*!< The text to scroll. */
+	unsigned long		delay;		/*!< The scroll delay time in milliseconds. */
+	uint8_t				toLeft;		/*!< True if the text scrolls from right to left. */
+	uint8_t				marker;		/*!< Marks which digit we are printing on the current 7SEG display segment. */
+}scroll_t;
+
+/**
+ * \class Seg7Reference
+ *
+ * The original Seg7Display API, see Seg7Display.h for the documentation.
+ */
+class Seg7Reference
+{
+	public:
+					Seg7Reference();
+		uint8_t		begin(uint8_t pin, const unsigned char *table);
+		uint8_t 	setSegmentsArraySize(uint8_t size);
+		void	 	writeSegments(String txt);
+		void 		writeUpper(String txt);
+		void 		writeLower(String txt);
+		uint8_t 	writeOneSegment(uint8_t seg, char ch);
+		uint8_t 	readOneSegment(uint8_t seg, char& ch);
+		void		refresh();
+		void		scrollLowerEx(String str, unsigned int t, uint8_t left);
+		void 		scrollLower(unsigned int t, uint8_t left);
+		void		scrollUpperEx(String str, unsigned int t, uint8_t left);
+		void 		scrollUpper(unsigned int t, uint8_t left);
+		void		setDecimalPoints(uint8_t points);
+		void		setBlink(uint8_t digit, unsigned int on, unsigned int off);
+		void		stopBlink();
+		void		stopScroll( uint8_t displays);
+
+	private:
+		int					m_slaveSelectPin;
+		uint8_t				m_segmentSize;
+		disp_t				m_disp;
+		const unsigned char	*m_ascii_table;
+		scroll_t			m_scrollUpper;
+		scroll_t			m_scrollLower;
+		uint8_t				m_dps;
+		blink_t				m_blink;
+		
+		uint8_t 			asciiTo7seg(char ch);
+		void 				helperWrite(String& txt, char* buf, uint8_t len);
+		void 				helperScroll(scroll_t& scroll, char *disp);
+		void 				helperSetupScroll(String& str, scroll_t& scroll, char *disp, unsigned int t, uint8_t left);
+		void 				sendSPImessage(unsigned char ch, unsigned char pos);
+};
+
+} // namespace seg7ref
+
+#endif // Seg7Reference_h
@@ -0,0 +1,174 @@
+/**
+ * @file   test_boot.cpp
+ * @date   October, 2026
+ * @brief  Boot frame save and restore, with the AVR and the ESP EEPROM libraries.
+ *
+ * Built twice, once as is and once with ESP8266 defined. On ESP the library must only start
+ * EEPROM when the sketch has not, and must keep a buffer the sketch started, together with
+ * its uncommitted writes.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include <Seg7Display.h>
+#include <EEPROM.h>
+#include "harness.h"
+
+#define BOOT_BYTES	(SEG7_BOOT_FRAME_ADDR + SEG7_BOOT_FRAME_SIZE)
+
+// Power off: drop what is only in RAM and start the next test from a blank boot frame.
+static void powerCycle(bool erase)
+{
+#if defined(ESP8266) || defined(ESP32)
+	EEPROM.ram.clear();
+	EEPROM.begins = 0;
+	if( erase ) {
+		memset(EEPROM.flash, 0xFF, sizeof(EEPROM.flash));
+	}
+#else
+	if( erase ) {
+		memset(EEPROM.mem, 0xFF, sizeof(EEPROM.mem));
+	}
+#endif
+}
+
+// Start a display on the harness clock with the bus captured.
+static void setupDisplay(Seg7Display& seg, frameCapture_t& cap)
+{
+	cap.modules = 1;
+	seg.setClock(harnessClock);
+	seg.setBus(captureBus, &cap);
+	seg.begin(10, ASCII_FULL_TAB);
+}
+
+// A saved frame is shown again by begin() after a power cycle.
+static void testRoundTrip()
+{
+	Seg7Display seg[2];
+	frameCapture_t cap[2];
+	powerCycle(true);
+	harnessNow = 1000;
+
+	setupDisplay(seg[0], cap[0]);
+	seg[0].setSegmentsArraySize(8);
+	seg[0].writeSegments("12.3  Ab");
+	seg[0].setDecimalPoints(0x21);
+	seg[0].refresh();
+	CHECK(seg[0].saveBootFrame() == ALL_OK);
+	std::string saved = frameHex(takeFrame(cap[0], 8));
+
+	powerCycle(false);
+	setupDisplay(seg[1], cap[1]);
+	seg[1].refresh();
+	CHECK_STR(frameHex(takeFrame(cap[1], 8)), saved);
+
+	// Cleared, the next begin() starts dark.
+	seg[1].clearBootFrame();
+	powerCycle(false);
+	Seg7Display fresh;
+	frameCapture_t freshCap;
+	setupDisplay(fresh, freshCap);
+	fresh.refresh();
+	CHECK_STR(frameHex(takeFrame(freshCap, 8)), textFrame(ASCII_FULL_TAB, "        "));
+}
+
+// begin() again, to switch tables, keeps what the sketch wrote after power-up.
+static void testBeginTwice()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	powerCycle(true);
+	harnessNow = 1000;
+
+	setupDisplay(seg, cap);
+	seg.setSegmentsArraySize(8);
+	seg.writeSegments("8888.8888");
+	CHECK(seg.saveBootFrame() == ALL_OK);
+
+	powerCycle(false);
+	Seg7Display next;
+	frameCapture_t nextCap;
+	setupDisplay(next, nextCap);
+	next.writeSegments("runtime!");
+	next.setDecimalPoints(0x01);
+	CHECK(next.begin(10, ASCII_HEX_TAB) == ALL_OK);
+	next.refresh();
+	CHECK_STR(frameHex(takeFrame(nextCap, 8)), textFrame(ASCII_HEX_TAB, "runtime!", 0x01));
+	char ch = '\0';
+	CHECK(next.readOneSegment(0, ch) == ALL_OK && ch == 'r');
+}
+
+#if defined(ESP8266) || defined(ESP32)
+
+// The sketch has not started EEPROM: the library starts it once, big enough for the frame.
+static void testLibraryStartsEeprom()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	powerCycle(true);
+
+	setupDisplay(seg, cap);
+	CHECK(EEPROM.begins == 1);
+	CHECK(EEPROM.length() == BOOT_BYTES);
+	seg.writeSegments("8888");
+	CHECK(seg.saveBootFrame() == ALL_OK);
+	seg.clearBootFrame();
+	CHECK(seg.saveBootFrame() == ALL_OK);
+	CHECK(EEPROM.begins == 1);
+	CHECK(EEPROM.flash[SEG7_BOOT_FRAME_ADDR] == 'S');
+}
+
+// The sketch started EEPROM with room to spare and has writes of its own pending.
+// The library must not begin() again, which would drop them.
+static void testSketchStartedEeprom()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	powerCycle(true);
+
+	EEPROM.begin(512);
+	EEPROM.write(300, 0x42);
+	setupDisplay(seg, cap);
+	seg.writeSegments("Hi");
+	CHECK(seg.saveBootFrame() == ALL_OK);
+	seg.clearBootFrame();
+	CHECK(EEPROM.begins == 1);
+	CHECK(EEPROM.length() == 512);
+	CHECK(EEPROM.read(300) == 0x42);
+	CHECK(EEPROM.flash[300] == 0x42);		// Committed along with the boot frame.
+}
+
+// The sketch started EEPROM too small for the boot frame. It is left alone and the save fails.
+static void testSketchEepromTooSmall()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	powerCycle(true);
+
+	EEPROM.begin(8);
+	EEPROM.write(3, 0x42);
+	setupDisplay(seg, cap);
+	seg.writeSegments("Hi");
+	CHECK(seg.saveBootFrame() == ERROR_CODE_EEPROM_SIZE);
+	seg.clearBootFrame();
+	CHECK(EEPROM.begins == 1);
+	CHECK(EEPROM.length() == 8);
+	CHECK(EEPROM.read(3) == 0x42);
+	CHECK(EEPROM.flash[SEG7_BOOT_FRAME_ADDR] == 0xFF);
+}
+
+#endif
+
+int main()
+{
+	testRoundTrip();
+	testBeginTwice();
+#if defined(ESP8266) || defined(ESP32)
+	testLibraryStartsEeprom();
+	testSketchStartedEeprom();
+	testSketchEepromTooSmall();
+#endif
+	return harnessResult("test_boot");
+}
@@ -0,0 +1,134 @@
+/**
+ * @file   test_coalesce.cpp
+ * @date   October, 2026
+ * @brief  Latest-wins update coalescing.
+ *
+ * Every write is made on two displays, one coalescing and one not. Once the coalescing
+ * display has had time to apply what is pending, both must show the same frame, whatever
+ * mix of pending and in-place writers was used.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include <Seg7Display.h>
+#include "harness.h"
+
+#define INTERVAL	100
+
+/**
+ * \struct displayPair
+ *
+ * A coalescing display and a plain one, each with its own bus capture.
+ */
+typedef struct displayPair {
+	Seg7Display		seg[2];
+	frameCapture_t	cap[2];
+}displayPair_t;
+
+// Start both displays. seg[0] coalesces.
+static void setupPair(displayPair_t& p)
+{
+	harnessNow = 1000;
+	for( uint8_t i=0; i<2; i++) {
+		p.cap[i].modules = 1;
+		p.seg[i].setClock(harnessClock);
+		p.seg[i].setBus(captureBus, &p.cap[i]);
+		p.seg[i].begin(10, ASCII_FULL_TAB);
+		p.seg[i].setSegmentsArraySize(8);
+	}
+	p.seg[0].setMaxUpdateRate(INTERVAL);
+}
+
+// Let the coalescing display apply what is pending, then compare the frames.
+static bool settle(displayPair_t& p)
+{
+	std::string frame[2];
+	harnessNow += INTERVAL;
+	for( uint8_t i=0; i<2; i++) {
+		p.seg[i].refresh();
+		frame[i] = frameHex(takeFrame(p.cap[i], 8));
+	}
+	return CHECK_STR(frame[0], frame[1]);
+}
+
+// The case from the review: a clock written in place after pending text and points.
+static void testClockAfterPending()
+{
+	displayPair_t p;
+	setupPair(p);
+	
+	p.seg[0].writeSegments("11111111");
+	p.seg[0].setDecimalPoints(0);
+	p.seg[0].writeClock(DISPLAY_UPPER | DISPLAY_LOWER, 12, 34, 56);
+	p.seg[0].refresh();
+	CHECK_STR(frameHex(takeFrame(p.cap[0], 8)), textFrame(ASCII_FULL_TAB, "  123456", 0x14));
+	harnessNow += INTERVAL;
+	p.seg[0].refresh();
+	CHECK_STR(frameHex(takeFrame(p.cap[0], 8)), textFrame(ASCII_FULL_TAB, "  123456", 0x14));
+}
+
+// Make the same random call on both displays.
+static void randomCall(displayPair_t& p, harnessRandom_t& rnd)
+{
+	static const char* texts[] = { "", "1", "Ab", "1234", "-42-", "Octopart", "0123456789" };
+	const char* text = texts[harnessRand(rnd, sizeof(texts)/sizeof(texts[0]))];
+	uint8_t displays = 1 + harnessRand(rnd, 3);
+	uint16_t levels[8];
+	uint32_t arg = harnessRand(rnd, 0);
+	for( uint8_t i=0; i<8; i++) {
+		levels[i] = harnessRand(rnd, 120);
+	}
+	uint8_t op = harnessRand(rnd, 17);
+	
+	for( uint8_t i=0; i<2; i++) {
+		Seg7Display& seg = p.seg[i];
+		switch( op ) {
+			case 0:		seg.writeSegments(text);								break;
+			case 1:		seg.writeUpper(text);									break;
+			case 2:		seg.writeLower(text);									break;
+			case 3:		seg.setDecimalPoints(arg);								break;
+			case 4:		seg.setDecimalPoint(arg%2, arg%4, arg & 0x100);			break;
+			case 5:		seg.writeOneSegment(1 + arg%8, text[0] ? text[0] : '7');	break;
+			case 6:		seg.writeCounter(displays, arg % 100000, arg & 1);		break;
+			case 7:		seg.countUp(displays);									break;
+			case 8:		seg.countDown(displays);								break;
+			case 9:		seg.writeClock(displays, arg%24, arg%60, (arg>>8)%60);	break;
+			case 10:	seg.clockTick(displays);								break;
+			case 11:	seg.writeBarGraph(displays, arg%120, 100);				break;
+			case 12:	seg.writeLevels(displays, levels, 100);					break;
+			case 13:	seg.scrollLowerEx("abc", 10000, arg & 1);				break;
+			case 14:	seg.stopScroll(DISPLAY_UPPER | DISPLAY_LOWER);			break;
+			case 15:	seg.setCursor(arg%2, arg%4); seg.print(text);			break;
+			case 16:	seg.clear();											break;
+		}
+	}
+}
+
+// Random mixes of pending and in-place writers, settled after 1 to 6 calls.
+static void testRandomMix()
+{
+	harnessRandom_t rnd = { 35 };
+	for( int round=0; round<200; round++) {
+		displayPair_t p;
+		setupPair(p);
+		for( int n=0; n<50; n++) {
+			uint8_t calls = 1 + harnessRand(rnd, 6);
+			while( calls-- ) {
+				randomCall(p, rnd);
+			}
+			if( !settle(p) ) {
+				printf("    round %d, step %d\n", round, n);
+				return;
+			}
+		}
+	}
+}
+
+int main()
+{
+	testClockAfterPending();
+	testRandomMix();
+	return harnessResult("test_coalesce");
+}
@@ -0,0 +1,216 @@
+/**
+ * @file   test_font.cpp
+ * @date   October, 2026
+ * @brief  Fallback tables, font rules, glyph overrides and resetFont().
+ *
+ * Small tables with made up codes make every step of the lookup order visible: an override,
+ * then an exact match in any table in the order they were added, then the other case of a
+ * letter, then the look-alike. The resolved codes are read back with encode(), and from the
+ * bus for digits that were already on the display when the font changed.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include <Seg7Display.h>
+#include "harness.h"
+
+#define TABLE_START		'0'
+#define TABLE_END		'z'
+#define TABLE_BYTES		(TABLE_END - TABLE_START + 3)
+
+/**
+ * \struct fontCase
+ *
+ * A character and a made up code for it.
+ */
+typedef struct fontCase {
+	char		ch;
+	uint8_t		code;
+}fontCase_t;
+
+// The begin() table has 'A' but not 'a', and 'O' and '0' but not 'o'.
+static const fontCase_t baseCodes[] = { { 'A', 0x11 }, { 'O', 0x33 }, { '0', 0x44 }, { 'H', 0x66 }, { 'b', 0x10 }, { 0, 0 } };
+// The fallbacks both have 'z', so the first one added must win.
+static const fontCase_t fallbackCodes[2][4] = {
+	{ { 'a', 0x22 }, { 'z', 0x71 }, { 0, 0 } },
+	{ { 'z', 0x72 }, { 'y', 0x73 }, { 'A', 0x7F }, { 0, 0 } },
+};
+
+static unsigned char baseTable[TABLE_BYTES];
+static unsigned char fallbackTable[2][TABLE_BYTES];
+
+// Fill a table in the begin() format: first and last character, then a code per character.
+static void makeTable(unsigned char* table, const fontCase_t* codes)
+{
+	memset(table, 0, TABLE_BYTES);
+	table[0] = TABLE_START;
+	table[1] = TABLE_END;
+	for( ; codes->ch; codes++) {
+		table[codes->ch - TABLE_START + 2] = codes->code;
+	}
+}
+
+// The resolved code of one character.
+static uint8_t codeOf(Seg7Display& seg, char ch)
+{
+	uint8_t code = 0xFF;
+	seg.encode(&ch, 1, &code);
+	return code;
+}
+
+// Start a display with the base table on the harness clock with the bus captured.
+static void setupDisplay(Seg7Display& seg, frameCapture_t& cap)
+{
+	harnessNow = 1000;
+	cap.modules = 1;
+	seg.setClock(harnessClock);
+	seg.setBus(captureBus, &cap);
+	seg.begin(10, baseTable);
+	seg.setSegmentsArraySize(8);
+}
+
+// Fallback tables fill in what the begin() table lacks, in the order they were added.
+static void testFallbackOrder()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	setupDisplay(seg, cap);
+
+	CHECK(codeOf(seg, 'a') == 0);
+	CHECK(codeOf(seg, 'z') == 0);
+	CHECK(seg.addFallbackTable(fallbackTable[0]) == ALL_OK);
+	CHECK(codeOf(seg, 'a') == 0x22);
+	CHECK(codeOf(seg, 'z') == 0x71);
+	CHECK(seg.addFallbackTable(fallbackTable[1]) == ALL_OK);
+	CHECK(codeOf(seg, 'z') == 0x71);			// First fallback wins.
+	CHECK(codeOf(seg, 'y') == 0x73);
+	CHECK(codeOf(seg, 'A') == 0x11);			// The begin() table wins over both.
+	CHECK(seg.addFallbackTable(baseTable) == ERROR_CODE_OUT_OF_RANGE);
+	CHECK(codeOf(seg, (char)0x80) == 0);		// Outside the font.
+}
+
+// Case folding and look-alikes, each alone and together.
+static void testRules()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	setupDisplay(seg, cap);
+	seg.addFallbackTable(fallbackTable[0]);
+
+	// None: only exact matches.
+	CHECK(codeOf(seg, 'o') == 0);
+	CHECK(codeOf(seg, 'h') == 0);
+	CHECK(codeOf(seg, 'k') == 0);
+
+	seg.setFontRules(SEG7_FONT_FOLD_CASE);
+	CHECK(codeOf(seg, 'o') == 0x33);			// 'O'.
+	CHECK(codeOf(seg, 'h') == 0x66);			// 'H'.
+	CHECK(codeOf(seg, 'a') == 0x22);			// Exact in the fallback wins over 'A' in the begin() table.
+	CHECK(codeOf(seg, 'B') == 0x10);			// 'b'.
+	CHECK(codeOf(seg, '1') == 0);				// Not a letter, nothing to fold.
+	CHECK(codeOf(seg, 'k') == 0);				// Neither case in any table.
+
+	seg.setFontRules(SEG7_FONT_LOOKALIKE);
+	CHECK(codeOf(seg, 'o') == 0x44);			// '0'.
+	CHECK(codeOf(seg, 'K') == 0x66);			// 'H'.
+	CHECK(codeOf(seg, 'k') == 0);				// 'h', and folding is off.
+	CHECK(codeOf(seg, 'a') == 0x22);			// Exact match, the rules do not apply.
+
+	seg.setFontRules(SEG7_FONT_FOLD_CASE | SEG7_FONT_LOOKALIKE);
+	CHECK(codeOf(seg, 'o') == 0x33);			// The other case wins over the look-alike.
+	CHECK(codeOf(seg, 'k') == 0x66);			// 'h', folded to 'H'.
+	CHECK(codeOf(seg, 'S') == 0);				// '5' is not in any table.
+
+	seg.setFontRules(0);
+	CHECK(codeOf(seg, 'o') == 0);
+}
+
+// An override wins over everything and is kept when the rest of the font changes.
+static void testGlyphs()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	setupDisplay(seg, cap);
+
+	CHECK(seg.setGlyph('b', 0x5A) == ALL_OK);
+	CHECK(seg.setGlyph('o', 0x5C) == ALL_OK);
+	CHECK(seg.setGlyph((char)0x80, 0x01) == ERROR_CODE_OUT_OF_RANGE);
+	CHECK(codeOf(seg, 'b') == 0x5A);			// Over the begin() table.
+	CHECK(codeOf(seg, (char)0x80) == 0);
+
+	seg.setFontRules(SEG7_FONT_FOLD_CASE | SEG7_FONT_LOOKALIKE);
+	seg.addFallbackTable(fallbackTable[0]);
+	CHECK(codeOf(seg, 'o') == 0x5C);			// Over the rules.
+	CHECK(codeOf(seg, 'B') == 0x10);			// Folds to the table 'b', not to the override.
+	CHECK(seg.begin(10, baseTable) == ALL_OK);
+	CHECK(codeOf(seg, 'b') == 0x5A);			// Over a new begin() too.
+	CHECK(seg.setGlyph('b', 0x00) == ALL_OK);
+	CHECK(codeOf(seg, 'b') == 0);				// A blank override is still an override.
+}
+
+// resetFont() drops the fallbacks, rules and overrides and keeps the begin() table.
+static void testResetFont()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	setupDisplay(seg, cap);
+	seg.addFallbackTable(fallbackTable[0]);
+	seg.addFallbackTable(fallbackTable[1]);
+	seg.setFontRules(SEG7_FONT_FOLD_CASE | SEG7_FONT_LOOKALIKE);
+	seg.setGlyph('b', 0x5A);
+
+	seg.resetFont();
+	CHECK(codeOf(seg, 'b') == 0x10);
+	CHECK(codeOf(seg, 'a') == 0);
+	CHECK(codeOf(seg, 'o') == 0);
+	CHECK(codeOf(seg, 'A') == 0x11);
+	CHECK(seg.addFallbackTable(fallbackTable[1]) == ALL_OK);	// Both entries are free again.
+	CHECK(seg.addFallbackTable(fallbackTable[0]) == ALL_OK);
+	CHECK(codeOf(seg, 'z') == 0x72);
+}
+
+// Digits already on the display are drawn with the new font at the next refresh().
+static void testShownDigits()
+{
+	static const uint8_t shown[][8] = {
+		{ 0x10, 0x00, 0x00, 0x11, 0, 0, 0, 0 },
+		{ 0x10, 0x33, 0x22, 0x11, 0, 0, 0, 0 },
+		{ 0x5A, 0x33, 0x22, 0x11, 0, 0, 0, 0 },
+		{ 0x10, 0x00, 0x00, 0x11, 0, 0, 0, 0 },
+	};
+	Seg7Display seg;
+	frameCapture_t cap;
+	setupDisplay(seg, cap);
+
+	seg.writeSegments("boaA");
+	for( uint8_t step=0; step<4; step++) {
+		if( step == 1 ) {
+			seg.setFontRules(SEG7_FONT_FOLD_CASE);
+			seg.addFallbackTable(fallbackTable[0]);
+		}
+		else if( step == 2 ) {
+			seg.setGlyph('b', 0x5A);
+		}
+		else if( step == 3 ) {
+			seg.resetFont();
+		}
+		seg.refresh();
+		CHECK_STR(frameHex(takeFrame(cap, 8)), frameHex(std::vector<uint8_t>(shown[step], shown[step] + 8)));
+	}
+}
+
+int main()
+{
+	makeTable(baseTable, baseCodes);
+	makeTable(fallbackTable[0], fallbackCodes[0]);
+	makeTable(fallbackTable[1], fallbackCodes[1]);
+
+	testFallbackOrder();
+	testRules();
+	testGlyphs();
+	testResetFont();
+	testShownDigits();
+	return harnessResult("test_font");
+}
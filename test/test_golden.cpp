@@ -0,0 +1,787 @@
+/**
+ * @file   test_golden.cpp
+ * @date   October, 2026
+ * @brief  Golden-frame equivalence suite.
+ *
+ * A corpus of sketches (the two examples in Seg7Display.h, every table, scrolling both
+ * ways, blink masks and decimal points) is run on the virtual clock with one loop() per
+ * millisecond, and every frame change on the bus is logged with its time.
+ *
+ *  - The logs must match the golden files in golden/, recorded from the reference model
+ *    in reference/ with "test_golden --record".
+ *  - The same corpus, and random sketches compared frame by frame with the reference
+ *    model, must give the same frames in every scan mode: SPI or bus hook, segment
+ *    budgets, coalescing, and wider digit masks (test_golden_wide).
+ *  - With a segment budget, no bus frame may light more segments than the budget, the
+ *    sub-frames of each slot must OR to readFrame(), and every lit segment must be on in
+ *    exactly one of the same number of sub-frames per slot, so all are on equally long.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include <fstream>
+#include <sstream>
+#include <Seg7Display.h>
+#include "reference/Seg7Reference.h"
+#include "harness.h"
+
+using seg7ref::Seg7Reference;
+
+#define START_MS		1000UL
+
+/// Frame changes: time since setup() and the frame.
+typedef std::vector< std::pair<unsigned long, std::string> > frameLog_t;
+
+/**
+ * \struct variant
+ *
+ * A way to run the library. The reference model always runs plain.
+ */
+typedef struct variant {
+	const char*		name;
+	uint8_t			bus;			/*!< Frames through setBus() instead of SPI. */
+	uint8_t			budget;			/*!< setSegmentBudget(), 0 for none. */
+	uint16_t		coalesce;		/*!< setMaxUpdateRate(), 0 for none. */
+}variant_t;
+
+static const variant_t PLAIN = { "plain", 0, 0, 0 };
+
+static const variant_t VARIANTS[] = {
+	{ "plain",		0, 0, 0 },
+	{ "bus hook",	1, 0, 0 },
+	{ "budget 1",	0, 1, 0 },
+	{ "budget 3",	1, 3, 0 },
+	{ "budget 7",	0, 7, 0 },
+	{ "coalesce",	0, 0, 1 },
+	{ "all",		1, 2, 1 },
+};
+
+// Set up a scan mode on the library.
+static void applyVariant(Seg7Display& seg, const variant_t& v, frameCapture_t& cap)
+{
+	if( v.bus ) {
+		seg.setBus(captureBus, &cap);
+	}
+	seg.setSegmentBudget(v.budget);
+	seg.setMaxUpdateRate(v.coalesce);
+}
+
+// The reference model has no scan modes.
+static void applyVariant(Seg7Reference&, const variant_t&, frameCapture_t&)
+{
+}
+
+// Run a sketch with one loop() per step() ms and log the frame changes.
+template<class D, class S>
+static frameLog_t runSketch(const S& proto, const variant_t& v)
+{
+	S sketch = proto;
+	D seg;
+	frameCapture_t cap;
+	frameLog_t log;
+	std::string last;
+	
+	cap.modules = 1;
+	mockSetMillis(START_MS);
+	applyVariant(seg, v, cap);
+	sketch.setup(seg);
+	SPI.log.clear();
+	cap.words.clear();
+	
+	unsigned long start = millis();
+	while( millis() - start < sketch.duration ) {
+		sketch.loop(seg);
+		captureSPI(cap);
+		std::string frame = frameHex(takeFrame(cap, 8));
+		if( frame != last ) {
+			log.push_back(std::make_pair(millis() - start, frame));
+			last = frame;
+		}
+		delay(sketch.step());
+	}
+	return log;
+}
+
+// Check two logs are the same, and show the first difference if not.
+static bool sameLog(const frameLog_t& got, const frameLog_t& expected, const std::string& what)
+{
+	size_t i = 0;
+	while( i<got.size() && i<expected.size() && got[i] == expected[i] ) {
+		i++;
+	}
+	bool same = (i == got.size() && i == expected.size());
+	if( !CHECK(same) ) {
+		printf("    %s: first difference at change %u\n", what.c_str(), (unsigned)i);
+		if( i < got.size() ) {
+			printf("    got      %lu %s\n", got[i].first, got[i].second.c_str());
+		}
+		if( i < expected.size() ) {
+			printf("    expected %lu %s\n", expected[i].first, expected[i].second.c_str());
+		}
+	}
+	return same;
+}
+
+// Path of a golden file. ctest runs in the test source directory.
+static std::string goldenPath(const char* name)
+{
+	return std::string("golden/") + name + ".txt";
+}
+
+// Write a golden file.
+static void writeGolden(const char* name, const frameLog_t& log)
+{
+	std::ofstream out(goldenPath(name).c_str());
+	out << "# Golden frames for the " << name << " sketch in test_golden.cpp.\n";
+	out << "# Recorded from the reference model with: test_golden --record\n";
+	out << "# One line per frame change: <ms since setup()> <7SEG code of digit 0..7 in hex>\n";
+	for( size_t i=0; i<log.size(); i++) {
+		out << log[i].first << " " << log[i].second << "\n";
+	}
+}
+
+// Read a golden file. Returns false if it is missing.
+static bool readGolden(const char* name, frameLog_t& log)
+{
+	std::ifstream in(goldenPath(name).c_str());
+	std::string line;
+	if( !in ) {
+		return false;
+	}
+	while( std::getline(in, line) ) {
+		if( line.empty() || line[0] == '#' ) {
+			continue;
+		}
+		std::istringstream fields(line);
+		unsigned long t;
+		std::string frame;
+		fields >> t >> frame;
+		log.push_back(std::make_pair(t, frame));
+	}
+	return true;
+}
+
+//  =========================================================================
+//  The corpus.
+//
+//  =========================================================================
+
+/**
+ * \class ExampleOne
+ *
+ * Example 1 from Seg7Display.h, with a loop() that refreshes. The example calls
+ * setSegmentsSize(), which is setSegmentsArraySize() in the library.
+ */
+class ExampleOne
+{
+	public:
+		unsigned long	duration;
+		
+		ExampleOne() : duration(50) {}
+		unsigned long	step()						{ return 1; }
+		template<class D>
+		void			setup(D& seg)
+		{
+			seg.begin( 10, ASCII_FULL_TAB );
+			seg.setSegmentsArraySize(8);
+			seg.writeSegments("Octopart");
+		}
+		template<class D>
+		void			loop(D& seg)				{ seg.refresh(); }
+};
+
+/**
+ * \class ExampleTwo
+ *
+ * Example 2 from Seg7Display.h, as written there, for a little more than two rounds.
+ */
+class ExampleTwo
+{
+	public:
+		unsigned long	duration;
+		unsigned int	loopDelay;
+		uint8_t			show;
+		unsigned long	t1;
+		
+		ExampleTwo() : duration(60000), loopDelay(1000), show(0), t1(0) {}
+		unsigned long	step()						{ return 1; }
+		
+		template<class D>
+		void			setup(D& seg)
+		{
+			static const char frame[] = {0x0c,0x01,0x01,0x0b,0x0e,0x04,0x04,0x0d,0x00};
+			seg.begin( 10, ASCII_FULL_TAB );
+			seg.setSegmentsArraySize(8);
+			
+			seg.writeSegments( frame );
+			t1 = millis();
+			delay( 1000 );
+			t1 = millis();
+		}
+		
+		template<class D>
+		void			loop(D& seg)
+		{
+			static const char signs[] = {0x0b,0x0c,0x0b,0x0c,0x00};
+			seg.refresh();
+			
+			unsigned long t2 = millis();
+			if( t2-t1 > loopDelay ) {
+				t1 = t2;
+				switch( show++ ) {
+					case 0:
+						seg.writeSegments("Octopart");
+						loopDelay = 1000;
+					break;
+					
+					case 1:
+						seg.stopBlink();
+						seg.scrollUpperEx("Hello ",300,1);
+						seg.writeLower(" Crn");
+						loopDelay = 5000;
+					break;
+					
+					case 2:
+						seg.stopScroll( DISPLAY_UPPER );
+						seg.writeUpper("____");
+						seg.scrollLowerEx("WUorld ",200,0);
+						loopDelay = 5000;
+					break;
+					
+					case 3:
+						seg.stopScroll( DISPLAY_LOWER );
+						seg.writeSegments("Octopart");
+						seg.setBlink(0xFF,800,400);
+						loopDelay = 5000;
+					break;
+					
+					case 4:
+						seg.stopBlink();
+						seg.writeUpper("1234");
+						seg.setDecimalPoints(0x20);
+						seg.setBlink(0x10,400,100);
+						seg.scrollLowerEx(signs,300,1);
+						loopDelay = 5000;
+					break;
+					
+					default:
+						seg.stopBlink();
+						seg.stopScroll( DISPLAY_UPPER | DISPLAY_LOWER );
+						seg.setDecimalPoints(0x00);
+						show=0;
+						loopDelay = 500;
+				};
+			}
+		}
+};
+
+/**
+ * \class TableSketch
+ *
+ * Every character from 1 to 255 through one begin() table, 8 at a time, 10 ms each.
+ */
+class TableSketch
+{
+	public:
+		unsigned long			duration;
+		const unsigned char*	table;
+		unsigned long			t;
+		int						ch;
+		
+		TableSketch(const unsigned char* tab) : duration(330), table(tab), t(0), ch(1) {}
+		unsigned long	step()						{ return 1; }
+		template<class D>
+		void			setup(D& seg)
+		{
+			seg.begin( 10, table );
+			seg.setSegmentsArraySize(8);
+			t = millis();
+		}
+		template<class D>
+		void			loop(D& seg)
+		{
+			seg.refresh();
+			if( millis() - t >= 10 && ch < 256 ) {
+				char text[9];
+				for( uint8_t i=0; i<8; i++, ch++) {
+					text[i] = (ch < 256) ? (char)ch : ' ';
+				}
+				text[8] = '\0';
+				seg.writeSegments(text);
+				t = millis();
+			}
+		}
+};
+
+/**
+ * \class ScriptSketch
+ *
+ * Refreshes every ms and calls an action at fixed times. Subclasses give the actions.
+ */
+class ScriptSketch
+{
+	public:
+		unsigned long	duration;
+		const unsigned long*	times;
+		uint8_t			next;
+		unsigned long	start;
+		
+		ScriptSketch(unsigned long d, const unsigned long* t) : duration(d), times(t), next(0), start(0) {}
+		unsigned long	step()						{ return 1; }
+		template<class D>
+		void			setup(D& seg)
+		{
+			seg.begin( 10, ASCII_FULL_TAB );
+			seg.setSegmentsArraySize(8);
+			start = millis();
+		}
+		
+		// The number of the action that is due, or -1.
+		int				due()
+		{
+			if( times[next] && millis() - start >= times[next] ) {
+				return next++;
+			}
+			return -1;
+		}
+};
+
+// Times of the scroll actions, 0 terminated. The first action is at the first loop().
+static const unsigned long SCROLL_TIMES[] = { 1, 2000, 5000, 6000, 9000, 12000, 12500, 0 };
+
+/**
+ * \class ScrollSketch
+ *
+ * Both rows scrolling in both directions, with given texts and the text on the display.
+ */
+class ScrollSketch : public ScriptSketch
+{
+	public:
+		ScrollSketch() : ScriptSketch(16000, SCROLL_TIMES) {}
+		template<class D>
+		void			loop(D& seg)
+		{
+			seg.refresh();
+			switch( due() ) {
+				case 0:
+					seg.writeSegments("12345678");
+					seg.scrollUpperEx("Hello ",300,1);
+				break;
+				case 1:
+					seg.scrollLowerEx("WUorld ",200,0);
+				break;
+				case 2:
+					seg.stopScroll( DISPLAY_UPPER );
+					seg.writeUpper("____");
+				break;
+				case 3:
+					seg.scrollUpper(150,0);
+				break;
+				case 4:
+					seg.writeLower("Ab");
+					seg.scrollLower(100,1);
+				break;
+				case 5:
+					seg.stopScroll( DISPLAY_UPPER | DISPLAY_LOWER );
+				break;
+				case 6:
+					seg.scrollUpperEx("AbCdEfGh",50,0);
+					seg.scrollLowerEx("0123456789",75,1);
+				break;
+			}
+		}
+};
+
+// Times of the blink actions, 0 terminated.
+static const unsigned long BLINK_TIMES[] = { 1, 1500, 3000, 6000, 8000, 9000, 11000, 11500, 0 };
+
+/**
+ * \class BlinkSketch
+ *
+ * Blink masks with different timings, joined groups, and blinking over changing text.
+ */
+class BlinkSketch : public ScriptSketch
+{
+	public:
+		BlinkSketch() : ScriptSketch(15000, BLINK_TIMES) {}
+		template<class D>
+		void			loop(D& seg)
+		{
+			seg.refresh();
+			switch( due() ) {
+				case 0:
+					seg.writeSegments("88888888");
+					seg.setDecimalPoints(0xFF);
+					seg.setBlink(0x80,500,500);
+				break;
+				case 1:
+					seg.setBlink(0x01,200,300);
+				break;
+				case 2:
+					seg.setBlink(0xA5,800,400);
+				break;
+				case 3:
+					seg.setBlink(0x5A,800,400);
+				break;
+				case 4:
+					seg.stopBlink();
+					seg.setBlink(0xFF,100,100);
+				break;
+				case 5:
+					seg.setBlink(0x0F,300,700);
+				break;
+				case 6:
+					seg.stopBlink();
+				break;
+				case 7:
+					seg.setBlink(0xF0,1000,250);
+					seg.writeUpper("Abcd");
+				break;
+			}
+		}
+};
+
+/**
+ * \class PointSketch
+ *
+ * Every decimal point mask for 5 ms, then dots written as characters.
+ */
+class PointSketch
+{
+	public:
+		unsigned long	duration;
+		unsigned long	t;
+		int				mask;
+		
+		PointSketch() : duration(1400), t(0), mask(0) {}
+		unsigned long	step()						{ return 1; }
+		template<class D>
+		void			setup(D& seg)
+		{
+			seg.begin( 10, ASCII_FULL_TAB );
+			seg.setSegmentsArraySize(8);
+			seg.writeSegments("Octopart");
+			t = millis();
+		}
+		template<class D>
+		void			loop(D& seg)
+		{
+			seg.refresh();
+			if( millis() - t < 5 ) {
+				return;
+			}
+			t = millis();
+			if( mask < 256 ) {
+				seg.setDecimalPoints(mask++);
+			} else if( mask < 264 ) {
+				seg.writeOneSegment(mask++ - 255, '.');
+			} else if( mask == 264 ) {
+				seg.writeUpper("1.2.");
+				seg.writeLower("-.-");
+				mask++;
+			}
+		}
+};
+
+/**
+ * \class RandomSketch
+ *
+ * Random calls at random times, with 1 to 4 ms per loop(). The same seed gives the same
+ * calls on the library and on the reference model.
+ */
+class RandomSketch
+{
+	public:
+		unsigned long		duration;
+		harnessRandom_t		rnd;
+		
+		RandomSketch(uint32_t seed) : duration(5000) { rnd.state = seed; }
+		unsigned long	step()						{ return 1 + harnessRand(rnd, 4); }
+		
+		template<class D>
+		void			setup(D& seg)
+		{
+			static const unsigned char* tables[] = { ASCII_NUM_TAB, ASCII_HEX_TAB, ASCII_FULL_TAB };
+			seg.begin( 10, tables[harnessRand(rnd, 3)] );
+			seg.setSegmentsArraySize(8);
+		}
+		
+		template<class D>
+		void			loop(D& seg)
+		{
+			static const uint16_t blinks[3][2] = { {100,100}, {250,150}, {400,300} };
+			seg.refresh();
+			if( harnessRand(rnd, 50) ) {
+				return;
+			}
+			const uint16_t* blink = blinks[harnessRand(rnd, 3)];
+			switch( harnessRand(rnd, 14) ) {
+				case 0:		seg.writeSegments(text(0, 10).c_str());						break;
+				case 1:		seg.writeUpper(text(0, 6).c_str());							break;
+				case 2:		seg.writeLower(text(0, 6).c_str());							break;
+				case 3:		seg.writeOneSegment(1 + harnessRand(rnd, 8), text(1, 1)[0]);	break;
+				case 4:		seg.setDecimalPoints(harnessRand(rnd, 256));				break;
+				case 5:
+				case 6:		seg.setBlink(harnessRand(rnd, 256), blink[0], blink[1]);	break;
+				case 7:		seg.stopBlink();											break;
+				case 8:		seg.scrollUpperEx(text(1, 12).c_str(), 20 + harnessRand(rnd, 300), harnessRand(rnd, 2));	break;
+				case 9:		seg.scrollLowerEx(text(1, 12).c_str(), 20 + harnessRand(rnd, 300), harnessRand(rnd, 2));	break;
+				case 10:	seg.scrollUpper(20 + harnessRand(rnd, 300), harnessRand(rnd, 2));	break;
+				case 11:	seg.scrollLower(20 + harnessRand(rnd, 300), harnessRand(rnd, 2));	break;
+				case 12:	seg.stopScroll(1 + harnessRand(rnd, 3));					break;
+				case 13:	seg.writeSegments("");										break;
+			}
+		}
+		
+	private:
+		// Random text of min to max characters, including special characters below 32.
+		std::string		text(uint8_t min, uint8_t max)
+		{
+			static const char chars[] = "0123456789AbCdEFHhLOoPrUu -_.?=\x01\x0b\x0c";
+			std::string s;
+			uint8_t n = min + harnessRand(rnd, max - min + 1);
+			while( n-- ) {
+				s += chars[harnessRand(rnd, sizeof(chars) - 1)];
+			}
+			return s;
+		}
+};
+
+/**
+ * \class FillSketch
+ *
+ * Random text, points and blinking over the whole framebuffer. Library only, for
+ * geometries the reference model does not have.
+ */
+class FillSketch
+{
+	public:
+		unsigned long		duration;
+		uint8_t				rows;
+		uint8_t				cols;
+		harnessRandom_t		rnd;
+		
+		FillSketch(uint8_t r, uint8_t c, uint32_t seed) : duration(3000), rows(r), cols(c) { rnd.state = seed; }
+		unsigned long	step()						{ return 1 + harnessRand(rnd, 4); }
+		void			setup(Seg7Display& seg)
+		{
+			seg.begin( 10, ASCII_FULL_TAB );
+			seg.setGeometry(rows, cols);
+		}
+		void			loop(Seg7Display& seg)
+		{
+			static const char chars[] = "0123456789AbCdEFHhLOoPrUu -_.?=8";
+			seg.refresh();
+			if( harnessRand(rnd, 20) ) {
+				return;
+			}
+			uint8_t row = harnessRand(rnd, rows);
+			uint8_t col = harnessRand(rnd, cols);
+			switch( harnessRand(rnd, 4) ) {
+				case 0: {
+					std::string text;
+					for( uint8_t i=0; i<cols; i++) {
+						text += chars[harnessRand(rnd, sizeof(chars) - 1)];
+					}
+					seg.writeRow(row, text.c_str());
+				}
+				break;
+				case 1:		seg.setDecimalPoint(row, col, harnessRand(rnd, 2));										break;
+				case 2:		seg.setBlinkRegion(row, col, 1, 1, 50 + 50*harnessRand(rnd, 3), 50 + 50*harnessRand(rnd, 3));	break;
+				case 3:		seg.stopBlink();																		break;
+			}
+		}
+};
+
+/**
+ * \struct budgetCheck
+ *
+ * Checks the frames of a budgeted scan as the bus hook sees them.
+ */
+typedef struct budgetCheck {
+	Seg7Display*	seg;
+	uint8_t			budget;
+	uint8_t			modules;
+	int				lastSlot;
+	uint8_t			frame[SEG7_MAX_DIGITS];		/*!< readFrame() when the scan started. */
+	uint8_t			orCode[SEG7_MAX_DIGITS];	/*!< OR of the sub-frames per digit. */
+	uint16_t		lit[SEG7_MAX_DIGITS];		/*!< Segments lit over the sub-frames per digit. */
+	uint8_t			count[8];					/*!< Sub-frames per slot. */
+	unsigned long	scans;
+}budgetCheck_t;
+
+// Check a finished scan: the sub-frames OR to the frame, and each segment is lit in exactly one.
+static bool endScan(budgetCheck_t& b)
+{
+	bool ok = true;
+	if( b.lastSlot < 0 ) {
+		return ok;
+	}
+	uint8_t slots = (uint8_t)(b.lastSlot + 1);
+	for( uint8_t m=0; m<b.modules; m++) {
+		for( uint8_t i=0; i<slots; i++) {
+			uint8_t d = m*8 + i;
+			ok &= CHECK(b.orCode[d] == b.frame[d]);
+			ok &= CHECK(b.lit[d] == (uint16_t)__builtin_popcount(b.orCode[d]));
+		}
+	}
+	for( uint8_t i=0; i<slots; i++) {
+		ok &= CHECK(b.count[i] == b.seg->subFrames());
+	}
+	memset(b.orCode, 0, sizeof(b.orCode));
+	memset(b.lit, 0, sizeof(b.lit));
+	memset(b.count, 0, sizeof(b.count));
+	b.lastSlot = -1;
+	b.scans++;
+	return ok;
+}
+
+// Bus hook for budgetCheck_t: check every SS frame against the budget.
+static void budgetBus(void* ctx, const uint16_t* words, uint8_t count)
+{
+	budgetCheck_t& b = *(budgetCheck_t*)ctx;
+	uint8_t pos = words[0] & 0xFF;
+	int slot = 0;
+	while( slot<8 && pos != (0x80>>slot) ) {
+		slot++;
+	}
+	if( slot < b.lastSlot ) {
+		endScan(b);
+	}
+	if( b.lastSlot < 0 ) {
+		b.seg->readFrame(b.frame, SEG7_MAX_DIGITS);		// What this scan must show.
+	}
+	
+	uint8_t lit = 0;
+	CHECK(count == b.modules);
+	for( uint8_t x=0; x<count; x++) {
+		uint8_t code = words[x] >> 8;
+		uint8_t d = (count-1-x)*8 + slot;		// The last module's word goes out first.
+		lit += __builtin_popcount(code);
+		b.orCode[d] |= code;
+		b.lit[d] += __builtin_popcount(code);
+	}
+	CHECK(lit <= b.budget);
+	b.count[slot]++;
+	b.lastSlot = slot;
+}
+
+// Run a sketch on the library with a budget and check every scan.
+template<class S>
+static void checkBudgetRun(const S& proto, uint8_t budget, uint8_t modules)
+{
+	S sketch = proto;
+	Seg7Display seg;
+	budgetCheck_t b;
+	
+	memset(&b, 0, sizeof(b));
+	b.seg = &seg;
+	b.budget = budget;
+	b.modules = modules;
+	b.lastSlot = -1;
+	mockSetMillis(START_MS);
+	seg.setBus(budgetBus, &b);
+	seg.setSegmentBudget(budget);
+	sketch.setup(seg);
+	
+	unsigned long start = millis();
+	while( millis() - start < sketch.duration ) {
+		sketch.loop(seg);
+		if( !endScan(b) ) {
+			printf("    budget %u, %u modules, at %lu ms\n", budget, modules, millis() - start);
+			return;
+		}
+		uint8_t load[8];
+		uint8_t n = seg.readSegmentLoad(load, 8);
+		for( uint8_t i=0; i<n; i++) {
+			CHECK(load[i] <= budget);
+		}
+		delay(sketch.step());
+	}
+	CHECK(b.scans >= sketch.duration / 4);
+}
+
+// Budgets from 1 segment to more than a full slot, on the corpus and on random fills.
+static void checkBudget()
+{
+	for( uint8_t budget=1; budget<=9; budget++) {
+		checkBudgetRun(ExampleTwo(), budget, 1);
+		checkBudgetRun(BlinkSketch(), budget, 1);
+		checkBudgetRun(PointSketch(), budget, 1);
+		checkBudgetRun(RandomSketch(budget), budget, 1);
+		checkBudgetRun(FillSketch(2, 4, budget), budget, 1);
+#if SEG7_MAX_DIGITS >= 32
+		// Four modules: the budget is for the whole chain, i.e. all modules in one slot.
+		checkBudgetRun(FillSketch(4, 8, budget), budget, 4);
+		checkBudgetRun(FillSketch(4, 8, budget), budget * 4, 4);
+		checkBudgetRun(FillSketch(2, 12, budget), budget * 2, 3);
+#endif
+	}
+}
+
+//  =========================================================================
+//  The checks.
+//
+//  =========================================================================
+
+static bool recording = false;
+
+// Check a corpus sketch against its golden file in every scan mode.
+template<class S>
+static void checkCorpus(const char* name, const S& sketch)
+{
+	frameLog_t reference = runSketch<Seg7Reference>(sketch, PLAIN);
+	frameLog_t golden;
+	
+	if( recording ) {
+		writeGolden(name, reference);
+		printf("recorded %s: %u frame changes\n", name, (unsigned)reference.size());
+		return;
+	}
+	if( !CHECK(readGolden(name, golden)) ) {
+		printf("    missing %s\n", goldenPath(name).c_str());
+		return;
+	}
+	sameLog(reference, golden, std::string(name) + " reference model");
+	for( size_t v=0; v<sizeof(VARIANTS)/sizeof(VARIANTS[0]); v++) {
+		sameLog(runSketch<Seg7Display>(sketch, VARIANTS[v]), golden, std::string(name) + ", " + VARIANTS[v].name);
+	}
+}
+
+// Compare random sketches with the reference model in every scan mode.
+static void checkRandom(uint32_t seeds)
+{
+	for( uint32_t seed=1; seed<=seeds; seed++) {
+		frameLog_t reference = runSketch<Seg7Reference>(RandomSketch(seed), PLAIN);
+		for( size_t v=0; v<sizeof(VARIANTS)/sizeof(VARIANTS[0]); v++) {
+			std::ostringstream what;
+			what << "random seed " << seed << ", " << VARIANTS[v].name;
+			if( !sameLog(runSketch<Seg7Display>(RandomSketch(seed), VARIANTS[v]), reference, what.str()) ) {
+				return;
+			}
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	recording = (argc > 1 && !strcmp(argv[1], "--record"));
+	
+	checkCorpus("example1", ExampleOne());
+	checkCorpus("example2", ExampleTwo());
+	checkCorpus("table_num", TableSketch(ASCII_NUM_TAB));
+	checkCorpus("table_hex", TableSketch(ASCII_HEX_TAB));
+	checkCorpus("table_full", TableSketch(ASCII_FULL_TAB));
+	checkCorpus("scroll", ScrollSketch());
+	checkCorpus("blink", BlinkSketch());
+	checkCorpus("decimal_points", PointSketch());
+	if( recording ) {
+		return 0;
+	}
+	
+	checkRandom(200);
+	checkBudget();
+	return harnessResult(argv[0]);
+}
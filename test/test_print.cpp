@@ -0,0 +1,106 @@
+/**
+ * @file   test_print.cpp
+ * @date   October, 2026
+ * @brief  print() and println() through the Print interface, on the default 2x4 layout.
+ *
+ * Row ends: a '\n' after a character that filled the last column must not move the cursor
+ * again, so full width rows printed with println() land on consecutive rows.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include <Seg7Display.h>
+#include "harness.h"
+
+// Start a display on the harness clock with the bus captured.
+static void setupDisplay(Seg7Display& seg, frameCapture_t& cap)
+{
+	harnessNow = 1000;
+	cap.modules = 1;
+	seg.setClock(harnessClock);
+	seg.setBus(captureBus, &cap);
+	seg.begin(10, ASCII_FULL_TAB);
+	seg.setSegmentsArraySize(8);
+}
+
+// The frame after a refresh, as hex.
+static std::string shown(Seg7Display& seg, frameCapture_t& cap)
+{
+	seg.refresh();
+	return frameHex(takeFrame(cap, 8));
+}
+
+// Full width rows printed with println() fill both rows, then start over at row 0.
+static void testFullRows()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	setupDisplay(seg, cap);
+
+	seg.println("1234");
+	seg.println("5678");
+	CHECK_STR(shown(seg, cap), textFrame(ASCII_FULL_TAB, "12345678"));
+	seg.println("ab");
+	CHECK_STR(shown(seg, cap), textFrame(ASCII_FULL_TAB, "ab  5678"));
+
+	// A trailing '.' is the decimal point of the last digit and keeps the row end pending.
+	seg.clear();
+	seg.println("12.34.");
+	seg.println("5");
+	CHECK_STR(shown(seg, cap), textFrame(ASCII_FULL_TAB, "12345   ", 0x50));
+
+	// Printing on without '\n' still runs on into the next row.
+	seg.clear();
+	seg.print("123456");
+	seg.println();
+	seg.print("ab");
+	CHECK_STR(shown(seg, cap), textFrame(ASCII_FULL_TAB, "ab3456  "));
+}
+
+// A second '\n' after a full row, and one after setCursor(), each blank a row.
+static void testEmptyRows()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	setupDisplay(seg, cap);
+
+	seg.print("88888888");
+	seg.setCursor(0, 0);
+	seg.println("1234");
+	seg.println();
+	CHECK_STR(shown(seg, cap), textFrame(ASCII_FULL_TAB, "1234    "));
+
+	seg.print("abcdefgh");
+	seg.setCursor(1, 0);
+	seg.println();
+	CHECK_STR(shown(seg, cap), textFrame(ASCII_FULL_TAB, "abcd    "));
+}
+
+// On a single row every println() of a full row starts over at column 0.
+static void testSingleRow()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	setupDisplay(seg, cap);
+	CHECK(seg.setGeometry(1, 8) == ALL_OK);
+
+	seg.println("12345678");
+	CHECK_STR(shown(seg, cap), textFrame(ASCII_FULL_TAB, "12345678"));
+	seg.println("abc");
+	CHECK_STR(shown(seg, cap), textFrame(ASCII_FULL_TAB, "abc     "));
+
+	// Without '\n' the framebuffer fills up and the rest is refused.
+	seg.clear();
+	CHECK(seg.print("123456789") == 8);
+	CHECK_STR(shown(seg, cap), textFrame(ASCII_FULL_TAB, "12345678"));
+}
+
+int main()
+{
+	testFullRows();
+	testEmptyRows();
+	testSingleRow();
+	return harnessResult("test_print");
+}
@@ -0,0 +1,388 @@
+/**
+ * @file   test_queue.cpp
+ * @date   October, 2026
+ * @brief  Seg7CommandQueue under real threads, and queued commands against direct calls.
+ *
+ * Several std::thread producers push numbered commands while one consumer pops them. Every
+ * command must arrive exactly once, in order per producer and with all of its bytes from
+ * the same push. The time of every push is measured and printed as a latency summary.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include <Seg7Display.h>
+#include "harness.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#define PRODUCERS	4
+#define PER_THREAD	50000
+#define INTERVAL	100
+
+typedef std::chrono::steady_clock stressClock_t;
+
+// Fill cmd with a command that tells who sent it, its number and a pattern of both.
+static void stampCommand(seg7Command_t& cmd, uint8_t producer, uint32_t n)
+{
+	cmd.op    = SEG7_CMD_WRITE;
+	cmd.arg   = producer;
+	cmd.time1 = (uint16_t)n;
+	cmd.time2 = (uint16_t)(n >> 16);
+	for( uint8_t i=0; i<sizeof(cmd.text); i++) {
+		cmd.text[i] = (char)('A' + (n*7 + i*3 + producer) % 26);
+	}
+}
+
+// True if every byte of cmd belongs to the command stamped for its producer and number.
+static bool wholeCommand(const seg7Command_t& cmd)
+{
+	seg7Command_t expect;
+	stampCommand(expect, cmd.arg, (uint32_t)cmd.time2 << 16 | cmd.time1);
+	return cmd.op == SEG7_CMD_WRITE && cmd.arg < PRODUCERS
+		&& memcmp(cmd.text, expect.text, sizeof(cmd.text)) == 0;
+}
+
+// Producers retry when the queue is full, so nothing may be lost, torn or reordered.
+static void testStress()
+{
+	Seg7CommandQueue queue;
+	std::atomic<int> running(PRODUCERS);
+	std::vector<uint64_t> latency[PRODUCERS];
+	std::vector<std::thread> producers;
+	uint32_t next[PRODUCERS] = { 0 };
+	uint32_t received = 0, torn = 0, reordered = 0;
+
+	for( uint8_t p=0; p<PRODUCERS; p++) {
+		latency[p].reserve(PER_THREAD);
+		producers.push_back(std::thread([&queue, &running, &latency, p]() {
+			seg7Command_t cmd;
+			for( uint32_t n=0; n<PER_THREAD; n++) {
+				stampCommand(cmd, p, n);
+				for(;;) {
+					stressClock_t::time_point t0 = stressClock_t::now();
+					uint8_t ret = queue.push(cmd);
+					stressClock_t::time_point t1 = stressClock_t::now();
+					if( ret == ALL_OK ) {
+						latency[p].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+						break;
+					}
+					std::this_thread::yield();
+				}
+			}
+			running--;
+		}));
+	}
+
+	// This thread is the single consumer.
+	seg7Command_t cmd;
+	for(;;) {
+		bool done = (running == 0);
+		if( queue.pop(cmd) ) {
+			received++;
+			if( !wholeCommand(cmd) ) {
+				torn++;
+				continue;
+			}
+			uint32_t n = (uint32_t)cmd.time2 << 16 | cmd.time1;
+			if( n != next[cmd.arg] ) {
+				reordered++;
+			}
+			next[cmd.arg] = n + 1;
+		} else if( done ) {
+			break;
+		} else {
+			std::this_thread::yield();
+		}
+	}
+	for( uint8_t p=0; p<PRODUCERS; p++) {
+		producers[p].join();
+	}
+
+	CHECK(received == PRODUCERS * PER_THREAD);
+	CHECK(torn == 0);
+	CHECK(reordered == 0);
+	for( uint8_t p=0; p<PRODUCERS; p++) {
+		CHECK(next[p] == PER_THREAD);
+	}
+
+	std::vector<uint64_t> all;
+	for( uint8_t p=0; p<PRODUCERS; p++) {
+		all.insert(all.end(), latency[p].begin(), latency[p].end());
+	}
+	std::sort(all.begin(), all.end());
+	if( CHECK(all.size() == PRODUCERS * PER_THREAD) ) {
+		printf("enqueue latency over %u pushes from %d threads: p50 %llu ns, p99 %llu ns, p99.9 %llu ns, max %llu ns\n",
+			(unsigned)all.size(), PRODUCERS,
+			(unsigned long long)all[all.size()/2],
+			(unsigned long long)all[all.size()*99/100],
+			(unsigned long long)all[all.size()*999/1000],
+			(unsigned long long)all.back());
+	}
+}
+
+// Producers that do not retry: every push is either received or counted as dropped.
+static void testDropCount()
+{
+	Seg7CommandQueue queue;
+	std::atomic<int> running(PRODUCERS);
+	std::atomic<uint32_t> accepted(0);
+	std::vector<std::thread> producers;
+	uint32_t received = 0, torn = 0;
+
+	for( uint8_t p=0; p<PRODUCERS; p++) {
+		producers.push_back(std::thread([&queue, &running, &accepted, p]() {
+			seg7Command_t cmd;
+			for( uint32_t n=0; n<PER_THREAD; n++) {
+				stampCommand(cmd, p, n);
+				if( queue.push(cmd) == ALL_OK ) {
+					accepted++;
+				}
+			}
+			running--;
+		}));
+	}
+
+	seg7Command_t cmd;
+	for(;;) {
+		bool done = (running == 0);
+		if( queue.pop(cmd) ) {
+			received++;
+			torn += !wholeCommand(cmd);
+		} else if( done ) {
+			break;
+		} else {
+			std::this_thread::yield();
+		}
+	}
+	for( uint8_t p=0; p<PRODUCERS; p++) {
+		producers[p].join();
+	}
+
+	CHECK(received == accepted);
+	CHECK(torn == 0);
+	// dropped() is a 16 bit counter and wraps.
+	CHECK((uint16_t)(PRODUCERS * PER_THREAD - accepted) == queue.dropped());
+}
+
+// Start a display on the harness clock with the bus captured.
+static void setupDisplay(Seg7Display& seg, frameCapture_t& cap)
+{
+	cap.modules = 1;
+	seg.setClock(harnessClock);
+	seg.setBus(captureBus, &cap);
+	seg.begin(10, ASCII_FULL_TAB);
+	seg.setSegmentsArraySize(8);
+}
+
+// Each producer owns one digit and counts on it. refresh() on this thread drains the
+// queue, so after the last push every digit shows its producer's last count.
+static void testDisplayThreads()
+{
+	Seg7Display seg;
+	Seg7CommandQueue queue;
+	frameCapture_t cap;
+	std::atomic<int> running(PRODUCERS);
+	std::vector<std::thread> producers;
+
+	harnessNow = 1000;
+	setupDisplay(seg, cap);
+	seg.attachQueue(&queue);
+
+	for( uint8_t p=0; p<PRODUCERS; p++) {
+		producers.push_back(std::thread([&queue, &running, p]() {
+			seg7Command_t cmd;
+			cmd.op = SEG7_CMD_WRITE_ONE;
+			cmd.arg = p + 1;
+			cmd.time1 = cmd.time2 = 0;
+			memset(cmd.text, ' ', sizeof(cmd.text));
+			for( uint32_t n=0; n<=PER_THREAD/10; n++) {
+				cmd.text[0] = (char)('0' + (n + p) % 10);
+				while( queue.push(cmd) != ALL_OK ) {
+					std::this_thread::yield();
+				}
+			}
+			running--;
+		}));
+	}
+	while( running ) {
+		seg.refresh();
+		cap.words.clear();
+		std::this_thread::yield();
+	}
+	for( uint8_t p=0; p<PRODUCERS; p++) {
+		producers[p].join();
+	}
+	for( uint8_t i=0; i<8; i++) {
+		seg.refresh();
+	}
+
+	char text[9] = "        ";
+	for( uint8_t p=0; p<PRODUCERS; p++) {
+		text[p] = (char)('0' + (PER_THREAD/10 + p) % 10);
+	}
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, text));
+}
+
+// A queued write goes through the same path as writeLower, coalescing included.
+static void testQueuedWrite()
+{
+	Seg7Display seg[2];
+	frameCapture_t cap[2];
+	Seg7CommandQueue queue;
+
+	harnessNow = 1000;
+	for( uint8_t i=0; i<2; i++) {
+		setupDisplay(seg[i], cap[i]);
+		seg[i].setMaxUpdateRate(INTERVAL);
+		seg[i].writeSegments("12345678");
+		seg[i].refresh();
+	}
+	seg[0].attachQueue(&queue);
+
+	// Both writes land while the interval is running, so only the last one is shown.
+	harnessNow += 10;
+	queue.pushWrite(DISPLAY_LOWER, "ab");
+	queue.pushWrite(DISPLAY_LOWER, "cd");
+	seg[0].refresh();
+	seg[1].writeLower("ab");
+	seg[1].writeLower("cd");
+	seg[1].refresh();
+	CHECK(seg[0].coalesceStats().dropped == 1);
+	CHECK(seg[0].coalesceStats().dropped == seg[1].coalesceStats().dropped);
+	CHECK_STR(frameHex(takeFrame(cap[0], 8)), textFrame(ASCII_FULL_TAB, "12345678"));
+
+	harnessNow += INTERVAL;
+	for( uint8_t i=0; i<2; i++) {
+		seg[i].refresh();
+	}
+	CHECK_STR(frameHex(takeFrame(cap[0], 8)), textFrame(ASCII_FULL_TAB, "1234cd  "));
+	CHECK_STR(frameHex(takeFrame(cap[1], 8)), textFrame(ASCII_FULL_TAB, "1234cd  "));
+
+	// A write to both rows pads the whole span, like writeSegments.
+	queue.pushWrite(DISPLAY_UPPER | DISPLAY_LOWER, "x");
+	harnessNow += INTERVAL;
+	seg[0].refresh();
+	harnessNow += INTERVAL;
+	seg[0].refresh();
+	CHECK_STR(frameHex(takeFrame(cap[0], 8)), textFrame(ASCII_FULL_TAB, "x       "));
+}
+
+// A queued scroll shows the same frames as scrollLowerEx and scrollUpperEx.
+static void testQueuedScroll()
+{
+	static const struct {
+		uint8_t		displays;
+		const char*	text;
+		uint16_t	t;
+		uint8_t		left;
+	} cases[] = {
+		{ DISPLAY_LOWER, "Hello ", 300, 1 },
+		{ DISPLAY_UPPER, "Abc", 120, 0 },
+		{ DISPLAY_UPPER | DISPLAY_LOWER, "12345678", 50, 1 },
+	};
+
+	for( uint8_t c=0; c<sizeof(cases)/sizeof(cases[0]); c++) {
+		Seg7Display seg[2];
+		frameCapture_t cap[2];
+		Seg7CommandQueue queue;
+		bool same = true;
+
+		harnessNow = 1000;
+		for( uint8_t i=0; i<2; i++) {
+			setupDisplay(seg[i], cap[i]);
+		}
+		seg[0].attachQueue(&queue);
+		CHECK(queue.pushScroll(cases[c].displays, cases[c].text, cases[c].t, cases[c].left) == ALL_OK);
+		seg[0].refresh();
+		if( cases[c].displays & DISPLAY_UPPER ) {
+			seg[1].scrollUpperEx(cases[c].text, cases[c].t, cases[c].left);
+		}
+		if( cases[c].displays & DISPLAY_LOWER ) {
+			seg[1].scrollLowerEx(cases[c].text, cases[c].t, cases[c].left);
+		}
+		seg[1].refresh();
+
+		for( uint16_t step=0; step<500 && same; step++) {
+			harnessNow += 7;
+			for( uint8_t i=0; i<2; i++) {
+				seg[i].refresh();
+			}
+			same = CHECK_STR(frameHex(takeFrame(cap[0], 8)), frameHex(takeFrame(cap[1], 8)));
+		}
+	}
+}
+
+// Queued region writes show the same frames as writeRegion, on any row and wider than 8.
+static void testQueuedRegion()
+{
+	static const struct {
+		uint8_t		rows, cols;
+		uint8_t		row, col, width, height;
+		const char*	text;
+	} cases[] = {
+		{ 2, 4, 1, 1, 2, 1, "ab" },
+		{ 2, 4, 0, 2, 2, 2, "1234" },
+		{ 2, 4, 0, 0, 4, 2, "x" },
+		{ 1, 8, 0, 3, 5, 1, "-42-Z" },
+#if SEG7_MAX_DIGITS >= 32
+		{ 3, 8, 2, 0, 8, 1, "ABCDEFGH" },
+		{ 4, 8, 3, 0, 8, 1, "Octopart" },
+		{ 4, 8, 1, 2, 4, 3, "0123456789AB" },
+		{ 2, 12, 1, 0, 12, 1, "Hello World!" },
+		{ 4, 8, 0, 0, 8, 4, "0123456789abcdefABCDEFGHIJKLMNOP" },
+#endif
+	};
+
+	for( uint8_t c=0; c<sizeof(cases)/sizeof(cases[0]); c++) {
+		Seg7Display seg[2];
+		frameCapture_t cap[2];
+		Seg7CommandQueue queue;
+		uint8_t size = cases[c].rows * cases[c].cols;
+
+		harnessNow = 1000;
+		for( uint8_t i=0; i<2; i++) {
+			setupDisplay(seg[i], cap[i]);
+			cap[i].modules = (size + 7) / 8;
+			CHECK(seg[i].setGeometry(cases[c].rows, cases[c].cols) == ALL_OK);
+			seg[i].writeSegments("################################");
+		}
+		seg[0].attachQueue(&queue);
+		CHECK(queue.pushWriteRegion(cases[c].row, cases[c].col, cases[c].width, cases[c].height, cases[c].text) == ALL_OK);
+		CHECK(seg[1].writeRegion(cases[c].row, cases[c].col, cases[c].width, cases[c].height, cases[c].text) == ALL_OK);
+		for( uint8_t i=0; i<2; i++) {
+			seg[i].refresh();
+		}
+		CHECK_STR(frameHex(takeFrame(cap[0], size)), frameHex(takeFrame(cap[1], size)));
+	}
+
+#if SEG7_MAX_DIGITS >= 16
+	// A queued write to both rows of 8 carries all 16 characters.
+	Seg7Display seg;
+	frameCapture_t cap;
+	Seg7CommandQueue queue;
+	setupDisplay(seg, cap);
+	cap.modules = 2;
+	seg.setGeometry(2, 8);
+	seg.attachQueue(&queue);
+	queue.pushWrite(DISPLAY_UPPER | DISPLAY_LOWER, "0123456789ABCDEF");
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 16)), textFrame(ASCII_FULL_TAB, "0123456789ABCDEF"));
+#endif
+}
+
+int main()
+{
+	testStress();
+	testDropCount();
+	testDisplayThreads();
+	testQueuedWrite();
+	testQueuedScroll();
+	testQueuedRegion();
+	return harnessResult("test_queue");
+}
@@ -0,0 +1,433 @@
+/**
+ * @file   test_timing.cpp
+ * @date   October, 2026
+ * @brief  Whole-day scroll and blink schedules on the virtual clock.
+ *
+ * The display runs for 24 hours of virtual time with random gaps between refresh() calls.
+ * Every frame on the bus is checked against a schedule worked out here from the
+ * documented timing rules, so both the frame contents and the millisecond each
+ * change shows up are pinned.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include <Seg7Display.h>
+#include "harness.h"
+
+#define DAY_MS		86400000UL
+#define START_MS	1000UL
+
+// Start a display on the harness clock with the bus hooked to cap.
+static void setupDisplay(Seg7Display& seg, frameCapture_t& cap, const char* text)
+{
+	harnessNow = START_MS;
+	mockSetMillis(0);
+	cap.modules = 1;
+	seg.setClock(harnessClock);
+	seg.setBus(captureBus, &cap);
+	seg.begin(10, ASCII_FULL_TAB);
+	seg.setSegmentsArraySize(8);
+	seg.writeSegments(text);
+}
+
+// True if a group set up at start with on/off times is lit at a refresh at time t.
+// Deadlines are start, start+on, start+on+off, ... and a group toggles at the first
+// refresh after each deadline, so it is lit when an odd number of deadlines are before t.
+static bool blinkLit(unsigned long start, unsigned long on, unsigned long off, unsigned long t)
+{
+	if( t <= start ) {
+		return false;
+	}
+	return (t - start - 1) % (on + off) < on;
+}
+
+// Blinking needs no time to set up and lights at the first refresh after the call.
+static void testBlinkStart()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	setupDisplay(seg, cap, "Octopart");
+	
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "Octopart"));
+	
+	seg.setBlink(0xF0, 500, 500);
+	CHECK(harnessNow == START_MS);				// No delay, on either clock.
+	CHECK(millis() == 0);
+	
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "Octopart", 0, 0xF0));
+	harnessNow++;
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "Octopart"));
+	harnessNow += 499;
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "Octopart"));
+	harnessNow++;
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "Octopart", 0, 0xF0));
+}
+
+// Two blink groups for 24 hours. Deadlines are phase-locked, so refresh jitter never adds up.
+static void testBlinkDay()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	harnessRandom_t rnd = { 36 };
+	setupDisplay(seg, cap, "Octopart");
+	seg.setDecimalPoints(0x11);
+	
+	seg.setBlink(0xF0, 800, 400);
+	unsigned long upper = harnessNow;
+	harnessNow += 123;
+	seg.setBlink(0x06, 250, 250);
+	unsigned long inner = harnessNow;
+	
+	unsigned long frames = 0;
+	unsigned long changes = 0;
+	std::string last;
+	for( ; harnessNow < START_MS + DAY_MS; harnessNow += 1 + harnessRand(rnd, 97)) {
+		seg.refresh();
+		std::string got = frameHex(takeFrame(cap, 8));
+		uint32_t dark = (blinkLit(upper, 800, 400, harnessNow) ? 0 : 0xF0) | (blinkLit(inner, 250, 250, harnessNow) ? 0 : 0x06);
+		if( !CHECK_STR(got, textFrame(ASCII_FULL_TAB, "Octopart", 0x11, dark)) ) {
+			break;
+		}
+		changes += (got != last);
+		last = got;
+		frames++;
+	}
+	printf("blink day: %lu frames, %lu changes\n", frames, changes);
+	CHECK(changes > 2 * DAY_MS / 1200);
+}
+
+/**
+ * \struct scrollModel
+ *
+ * The scroll rules: a step shifts in the next character once more than delay ms have
+ * passed since the last step, and the next step is timed from the refresh that made it.
+ */
+typedef struct scrollModel {
+	const char*		text;
+	unsigned long	delay;
+	unsigned long	time;
+	uint8_t			left;
+	uint8_t			marker;
+	char			shown[5];
+	unsigned long	steps;
+}scrollModel_t;
+
+// Start a model the way scrollUpperEx() and scrollLowerEx() start a scroll.
+static void modelStart(scrollModel_t& m, const char* text, unsigned long delay, uint8_t left)
+{
+	m.text = text;
+	m.delay = delay;
+	m.time = harnessNow;
+	m.left = left;
+	m.marker = left ? 0 : strlen(text) - 1;
+	strcpy(m.shown, "    ");
+	m.steps = 0;
+}
+
+// Step the model for a refresh at harnessNow.
+static void modelRefresh(scrollModel_t& m)
+{
+	uint8_t len = strlen(m.text);
+	if( harnessNow - m.time <= m.delay ) {
+		return;
+	}
+	if( m.left ) {
+		memmove(m.shown, m.shown + 1, 3);
+		m.shown[3] = m.text[m.marker];
+		m.marker = (m.marker + 1 == len) ? 0 : m.marker + 1;
+	} else {
+		memmove(m.shown + 1, m.shown, 3);
+		m.shown[0] = m.text[m.marker];
+		m.marker = m.marker ? m.marker - 1 : len - 1;
+	}
+	m.time = harnessNow;
+	m.steps++;
+}
+
+// Both rows scrolling, in opposite directions, for 24 hours.
+static void testScrollDay()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	harnessRandom_t rnd = { 3600 };
+	scrollModel_t upper;
+	scrollModel_t lower;
+	setupDisplay(seg, cap, "");
+	
+	seg.scrollUpperEx("Hello ", 300, 1);
+	modelStart(upper, "Hello ", 300, 1);
+	harnessNow += 57;
+	seg.scrollLowerEx("WUorld ", 200, 0);
+	modelStart(lower, "WUorld ", 200, 0);
+	
+	for( ; harnessNow < START_MS + DAY_MS; harnessNow += 1 + harnessRand(rnd, 97)) {
+		seg.refresh();
+		modelRefresh(upper);
+		modelRefresh(lower);
+		std::string text = std::string(upper.shown) + lower.shown;
+		if( !CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, text.c_str())) ) {
+			break;
+		}
+	}
+	printf("scroll day: %lu + %lu steps\n", upper.steps, lower.steps);
+	CHECK(upper.steps > DAY_MS / (300 + 97));
+	CHECK(lower.steps > DAY_MS / (200 + 97));
+}
+
+/**
+ * \struct streamModel
+ *
+ * Model of a streaming scroll. queue holds the characters the source has not handed out yet.
+ * A step is due when more than delay ms have passed since the last step. When the source is
+ * empty the step waits, and the first refresh after data arrives takes it.
+ */
+typedef struct streamModel {
+	std::string		queue;
+	unsigned long	delay;
+	unsigned long	time;
+	uint8_t			left;
+	char			shown[5];
+	unsigned long	steps;
+	unsigned long	waits;
+}streamModel_t;
+
+// Start a model the way scrollUpperStream() and scrollLowerRing() start a scroll.
+static void streamStart(streamModel_t& m, unsigned long delay, uint8_t left)
+{
+	m.queue.clear();
+	m.delay = delay;
+	m.time = harnessNow;
+	m.left = left;
+	strcpy(m.shown, "    ");
+	m.steps = 0;
+	m.waits = 0;
+}
+
+// Step the model for a refresh at harnessNow.
+static void streamRefresh(streamModel_t& m)
+{
+	if( harnessNow - m.time <= m.delay ) {
+		return;
+	}
+	if( m.queue.empty() ) {
+		m.waits++;
+		return;
+	}
+	if( m.left ) {
+		memmove(m.shown, m.shown + 1, 3);
+		m.shown[3] = m.queue[0];
+	} else {
+		memmove(m.shown + 1, m.shown, 3);
+		m.shown[0] = m.queue[0];
+	}
+	m.queue.erase(0, 1);
+	m.time = harnessNow;
+	m.steps++;
+}
+
+// A scrollSource_t over a string that the test appends to.
+static int feedPull(void* ctx)
+{
+	streamModel_t& feed = *(streamModel_t*)ctx;
+	if( feed.queue.empty() ) {
+		return -1;
+	}
+	int ch = (unsigned char)feed.queue[0];
+	feed.queue.erase(0, 1);
+	return ch;
+}
+
+// A ring drained by the scroll, then refilled one character at a time.
+static void testRingRefill()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	scrollRing_t ring;
+	char buf[4];
+	setupDisplay(seg, cap, "");
+	
+	Seg7Display::ringInit(ring, buf, sizeof(buf));
+	CHECK(Seg7Display::ringPush(ring, 'a') == ALL_OK);
+	CHECK(Seg7Display::ringPush(ring, 'b') == ALL_OK);
+	CHECK(Seg7Display::ringPush(ring, 'c') == ALL_OK);
+	CHECK(Seg7Display::ringPush(ring, 'x') == ERROR_CODE_OUT_OF_RANGE);	// size-1 characters fit.
+	seg.scrollLowerRing(ring, 100, 1);
+	
+	const char* frames[] = { "        ", "       a", "      ab", "     abc" };
+	for( uint8_t i=1; i<4; i++) {
+		harnessNow += 100;
+		seg.refresh();
+		CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, frames[i-1]));
+		harnessNow += 1;
+		seg.refresh();
+		CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, frames[i]));
+	}
+	
+	// Empty: the scroll waits as long as it takes, without stepping blanks in.
+	harnessNow += 5000;
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "     abc"));
+	CHECK(Seg7Display::ringPull(&ring) == -1);
+	
+	// Refilled: the overdue step is taken at the next refresh, then the delay applies again.
+	CHECK(Seg7Display::ringPush(ring, 'd') == ALL_OK);
+	CHECK(Seg7Display::ringPush(ring, 'e') == ALL_OK);
+	harnessNow += 1;
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "    abcd"));
+	harnessNow += 100;
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "    abcd"));
+	harnessNow += 1;
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "    bcde"));
+}
+
+// A callback scrolling left on the upper row and a ring scrolling right on the lower row,
+// both fed in random bursts with dry spells, for two hours.
+static void testStreamSchedule()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	harnessRandom_t rnd = { 2606 };
+	streamModel_t feed, upper, lower;
+	scrollRing_t ring;
+	char buf[8];
+	setupDisplay(seg, cap, "");
+	
+	Seg7Display::ringInit(ring, buf, sizeof(buf));
+	streamStart(feed, 0, 0);
+	seg.scrollUpperStream(feedPull, &feed, 150, 1);
+	streamStart(upper, 150, 1);
+	harnessNow += 33;
+	seg.scrollLowerRing(ring, 90, 0);
+	streamStart(lower, 90, 0);
+	
+	for( ; harnessNow < START_MS + 2*3600000UL; harnessNow += 1 + harnessRand(rnd, 60)) {
+		if( harnessRand(rnd, 100) < 4 ) {
+			for( uint32_t n=1+harnessRand(rnd, 6); n--; ) {
+				char ch = (char)('A' + harnessRand(rnd, 26));
+				feed.queue += ch;
+				upper.queue += ch;
+			}
+		}
+		if( harnessRand(rnd, 100) < 3 ) {
+			for( uint32_t n=1+harnessRand(rnd, 10); n--; ) {
+				char ch = (char)('0' + harnessRand(rnd, 10));
+				if( Seg7Display::ringPush(ring, ch) == ALL_OK ) {
+					lower.queue += ch;
+				}
+			}
+		}
+		seg.refresh();
+		streamRefresh(upper);
+		streamRefresh(lower);
+		std::string text = std::string(upper.shown) + lower.shown;
+		if( !CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, text.c_str())) ) {
+			break;
+		}
+	}
+	printf("stream schedule: %lu + %lu steps, %lu + %lu waits on empty\n", upper.steps, lower.steps, upper.waits, lower.waits);
+	CHECK(upper.steps > 10000 && lower.steps > 10000);
+	CHECK(upper.waits > 0 && lower.waits > 0);
+}
+
+// Switching a region from text to a stream frees the text's heap buffer.
+static void testStreamFreesText()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	streamModel_t feed;
+	setupDisplay(seg, cap, "");
+	streamStart(feed, 0, 0);
+	
+	long before = mockStringHeap;
+	seg.scrollUpperEx("A long message that needs a heap buffer", 100, 1);
+	CHECK(mockStringHeap > before + 32);
+	seg.scrollUpperStream(feedPull, &feed, 100, 1);
+	CHECK(mockStringHeap <= before);
+}
+
+// The library only reads the clock it is given: millis() stays at 0 all the time here.
+static void testClockHook()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	setupDisplay(seg, cap, "8888");
+	seg.scrollLowerEx("12", 100, 1);
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "8888    "));
+	harnessNow += 101;
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "8888   1"));
+	harnessNow += 101;
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "8888  12"));
+	CHECK(millis() == 0);
+}
+
+// A long gap between refresh() calls must not stop blinking. The group toggles at the first
+// refresh after the gap and runs its schedule from there.
+static void testBlinkGap()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	setupDisplay(seg, cap, "Octopart");
+	seg.setBlink(0xF0, 500, 500);
+	
+	for( int i=0; i<1200; i++, harnessNow++) {
+		seg.refresh();
+		takeFrame(cap, 8);
+	}
+	bool before = blinkLit(START_MS, 500, 500, harnessNow - 1);
+	
+	harnessNow += 40000;
+	unsigned long resync = harnessNow;
+	for( ; harnessNow < resync + 3000; harnessNow++) {
+		seg.refresh();
+		unsigned long toggles = 1 + ((harnessNow > resync) ? (harnessNow - resync - 1) / 500 : 0);
+		bool lit = before ^ (toggles & 1);
+		if( !CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "Octopart", 0, lit ? 0 : 0xF0)) ) {
+			break;
+		}
+	}
+}
+
+// Scroll delays longer than the 16 bit timers can hold are clamped, not wrapped to 0.
+static void testScrollDelayClamp()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	setupDisplay(seg, cap, "8888");
+	seg.scrollLowerEx("12", 65536, 1);
+	unsigned long start = harnessNow;
+	
+	for( ; harnessNow <= start + SEG7_MAX_SCROLL_DELAY; harnessNow += 7) {
+		seg.refresh();
+	}
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "8888    "));
+	harnessNow = start + SEG7_MAX_SCROLL_DELAY + 1;
+	seg.refresh();
+	CHECK_STR(frameHex(takeFrame(cap, 8)), textFrame(ASCII_FULL_TAB, "8888   1"));
+}
+
+int main()
+{
+	testBlinkStart();
+	testClockHook();
+	testBlinkGap();
+	testScrollDelayClamp();
+	testBlinkDay();
+	testScrollDay();
+	testRingRefill();
+	testStreamSchedule();
+	testStreamFreesText();
+	return harnessResult("test_timing");
+}
@@ -0,0 +1,184 @@
+/**
+ * @file   test_trace.cpp
+ * @date   October, 2026
+ * @brief  Trace points, built with SEG7_TRACE.
+ *
+ * The bus hook advances micros() by a fixed time per word, so every traced call has a known
+ * latency. The records of one refresh() are checked in order, the ring buffer is checked to
+ * copy out oldest first after it wrapped, and the histogram is read back through a Print.
+ *
+ * @license
+* ![Creative Commons License](https://i.creativecommons.org/l/by/4.0/88x31.png "Creative Commons License") This work is licensed under [Creative Commons Attribution 4.0 International License](http://creativecommons.org/licenses/by/4.0/)
+ *
+ */
+
+#include <Seg7Display.h>
+#include "harness.h"
+
+#ifndef SEG7_TRACE
+#error "test_trace must be built with SEG7_TRACE"
+#endif
+
+#define WORD_US		5
+
+#define ENTER(id)	(id)
+#define EXIT(id)	((id) | SEG7_TRACE_EXIT)
+
+/**
+ * \class capturePrint
+ *
+ * A Print that keeps what is printed.
+ */
+class capturePrint : public Print
+{
+	public:
+		size_t		write(uint8_t ch)			{ text += (char)ch; return 1; }
+		std::string	text;
+};
+
+// A seg7Bus_t that captures the words and takes WORD_US microseconds per word.
+static void slowBus(void* ctx, const uint16_t* words, uint8_t count)
+{
+	captureBus(ctx, words, count);
+	mockMicros += (unsigned long)count * WORD_US;
+}
+
+// Start a display on the harness clock with the slow bus.
+static void setupDisplay(Seg7Display& seg, frameCapture_t& cap)
+{
+	harnessNow = 1000;
+	cap.modules = 1;
+	seg.setClock(harnessClock);
+	seg.setBus(slowBus, &cap);
+	seg.begin(10, ASCII_FULL_TAB);
+	seg.setSegmentsArraySize(8);
+}
+
+// One histogram line as seg7TraceHistogram() prints it: one count per bucket.
+static std::string histLine(const char* name, uint8_t bucket, uint16_t n)
+{
+	std::string line = name;
+	for( uint8_t b=0; b<16; b++) {
+		line += b ? ' ' : ':';
+		line += std::to_string((b == bucket) ? n : 0);
+	}
+	return line + "\r\n";
+}
+
+// The records of one refresh() with a scroll step, in order and with the bus time in them.
+static void testRefreshRecords()
+{
+	static const uint8_t expect[] = {
+		ENTER(SEG7_TRACE_REFRESH),
+		ENTER(SEG7_TRACE_SCROLL), ENTER(SEG7_TRACE_DECODE), EXIT(SEG7_TRACE_DECODE), EXIT(SEG7_TRACE_SCROLL),
+		ENTER(SEG7_TRACE_BLINK), EXIT(SEG7_TRACE_BLINK),
+		ENTER(SEG7_TRACE_SPI), EXIT(SEG7_TRACE_SPI), ENTER(SEG7_TRACE_SPI), EXIT(SEG7_TRACE_SPI),
+		ENTER(SEG7_TRACE_SPI), EXIT(SEG7_TRACE_SPI), ENTER(SEG7_TRACE_SPI), EXIT(SEG7_TRACE_SPI),
+		ENTER(SEG7_TRACE_SPI), EXIT(SEG7_TRACE_SPI), ENTER(SEG7_TRACE_SPI), EXIT(SEG7_TRACE_SPI),
+		ENTER(SEG7_TRACE_SPI), EXIT(SEG7_TRACE_SPI), ENTER(SEG7_TRACE_SPI), EXIT(SEG7_TRACE_SPI),
+		EXIT(SEG7_TRACE_REFRESH),
+	};
+	const uint8_t n = sizeof(expect);
+	Seg7Display seg;
+	frameCapture_t cap;
+	seg7TraceRecord_t rec[SEG7_TRACE_SIZE];
+	setupDisplay(seg, cap);
+
+	seg.scrollLowerEx("AB", 100, 1);
+	harnessNow += 101;
+	seg.refresh();
+	uint16_t count = seg7TraceCopy(rec, SEG7_TRACE_SIZE);
+	if( !CHECK(count >= n) ) {
+		return;
+	}
+	const seg7TraceRecord_t* last = rec + count - n;
+	for( uint8_t i=0; i<n; i++) {
+		CHECK(last[i].id == expect[i]);
+	}
+	for( uint8_t i=7; i<n-1; i+=2) {
+		CHECK(last[i+1].time - last[i].time == WORD_US);
+	}
+	CHECK(last[n-1].time - last[0].time == 8 * WORD_US);
+
+	capturePrint out;
+	seg7TraceHistogram(last, n, out);
+	CHECK_STR(out.text,
+		histLine("refresh", 5, 1) +			// 40 us.
+		histLine("scroll", 0, 1) +
+		histLine("blink", 0, 1) +
+		histLine("decode", 0, 1) +
+		histLine("spi", 2, 8));				// 5 us each.
+}
+
+// After the ring wrapped, records come out oldest first and a short copy gets the newest.
+static void testWrapOrder()
+{
+	Seg7Display seg;
+	frameCapture_t cap;
+	seg7TraceRecord_t all[SEG7_TRACE_SIZE];
+	seg7TraceRecord_t tail[10];
+	setupDisplay(seg, cap);
+
+	for( uint8_t i=0; i<10; i++) {
+		seg.refresh();
+	}
+	uint16_t count = seg7TraceCopy(all, SEG7_TRACE_SIZE);
+	CHECK(count == SEG7_TRACE_SIZE);
+	CHECK(all[count-1].id == EXIT(SEG7_TRACE_REFRESH));
+	for( uint16_t i=1; i<count; i++) {
+		CHECK(all[i].time >= all[i-1].time);
+	}
+
+	// Every refresh is 20 records, so the wrapped copy starts with the last 4 of one.
+	CHECK(all[0].id == EXIT(SEG7_TRACE_SPI));
+	CHECK(all[3].id == EXIT(SEG7_TRACE_REFRESH));
+	CHECK(all[4].id == ENTER(SEG7_TRACE_REFRESH));
+	CHECK(all[SEG7_TRACE_SIZE-20].id == ENTER(SEG7_TRACE_REFRESH));
+
+	CHECK(seg7TraceCopy(tail, 10) == 10);
+	for( uint8_t i=0; i<10; i++) {
+		CHECK(tail[i].id == all[count-10+i].id && tail[i].time == all[count-10+i].time);
+	}
+
+	// Pairing skips the exits whose entry was lost to the wrap.
+	capturePrint out;
+	seg7TraceHistogram(all, count, out);
+	CHECK_STR(out.text,
+		histLine("refresh", 5, 3) +
+		histLine("scroll", 0, 0) +
+		histLine("blink", 0, 3) +
+		histLine("decode", 0, 0) +
+		histLine("spi", 2, 25));
+}
+
+// Nested and interleaved ids, an exit without an entry and an entry without an exit.
+static void testHistogramPairing()
+{
+	static const seg7TraceRecord_t rec[] = {
+		{ 0,    EXIT(SEG7_TRACE_SPI) },			// Entry lost, skipped.
+		{ 10,   ENTER(SEG7_TRACE_REFRESH) },
+		{ 12,   ENTER(SEG7_TRACE_SPI) },
+		{ 15,   EXIT(SEG7_TRACE_SPI) },			// 3 ticks, bucket 1.
+		{ 30,   EXIT(SEG7_TRACE_REFRESH) },		// 20 ticks, bucket 4.
+		{ 40,   ENTER(SEG7_TRACE_DECODE) },
+		{ 1064, EXIT(SEG7_TRACE_DECODE) },		// 1024 ticks, bucket 10.
+		{ 2000, ENTER(SEG7_TRACE_SCROLL) },		// Exit not recorded yet, skipped.
+		{ 2001, 0x7F },							// Unknown id, skipped.
+	};
+	capturePrint out;
+	seg7TraceHistogram(rec, sizeof(rec)/sizeof(rec[0]), out);
+	CHECK_STR(out.text,
+		histLine("refresh", 4, 1) +
+		histLine("scroll", 0, 0) +
+		histLine("blink", 0, 0) +
+		histLine("decode", 10, 1) +
+		histLine("spi", 1, 1));
+}
+
+int main()
+{
+	testRefreshRecords();
+	testWrapOrder();
+	testHistogramPairing();
+	return harnessResult("test_trace");
+}